@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file biquad_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of Filter_Biquad_Process_Buffer against Filter_Biquad_Process_Buffer_Ref
+ * Built with emu/arm_acle.h and -D__ARM_FEATURE_DSP the DSP version (smlad) is compared,
+ * otherwise the portable fallback.
+ * Half of the coefficient sets are plausible low pass filters, the other half are random
+ * to cover the wrap around and the saturation.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_filter.h"
+#include "ml_waveform.h"
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define CHECK_FILTER_CNT    2000
+#define CHECK_BLOCK_CNT     8
+#define CHECK_BLOCK_LEN     256
+
+
+static float sineTab[WAVEFORM_CNT];
+float *sine = sineTab;
+
+
+static int16_t ToQ14(double value)
+{
+    return (int16_t)lrint(fmax(-32768.0, fmin(32767.0, value * 16384.0)));
+}
+
+int main(void)
+{
+    long total = 0;
+    long diff = 0;
+
+    srand(1);
+
+    for (int t = 0; t < CHECK_FILTER_CNT; t++)
+    {
+        struct filterCoeffQ16T filterC;
+
+        if (t < CHECK_FILTER_CNT / 2)
+        {
+            const double w = M_PI * (0.001 + 0.9 * rand() / (double)RAND_MAX);
+            const double q = 0.5 + 8.0 * rand() / (double)RAND_MAX;
+            const double alpha = sin(w) / (2.0 * q);
+            const double a0 = 1.0 + alpha;
+
+            filterC.bNorm[0].s16 = ToQ14((1.0 - cos(w)) / 2.0 / a0);
+            filterC.bNorm[1].s16 = ToQ14((1.0 - cos(w)) / a0);
+            filterC.bNorm[2].s16 = ToQ14((1.0 - cos(w)) / 2.0 / a0);
+            filterC.aNorm[0].s16 = ToQ14(-2.0 * cos(w) / a0);
+            filterC.aNorm[1].s16 = ToQ14((1.0 - alpha) / a0);
+        }
+        else
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                filterC.bNorm[i].s16 = (int16_t)rand();
+            }
+            for (int i = 0; i < 2; i++)
+            {
+                filterC.aNorm[i].s16 = (int16_t)rand();
+            }
+        }
+
+        struct filterBiquadQ16T ref, dut;
+        Filter_Biquad_Init(&ref, &filterC);
+        Filter_Biquad_Init(&dut, &filterC);
+
+        for (int blk = 0; blk < CHECK_BLOCK_CNT; blk++)
+        {
+            Q1_14 sigRef[CHECK_BLOCK_LEN], sigDut[CHECK_BLOCK_LEN];
+
+            for (int n = 0; n < CHECK_BLOCK_LEN; n++)
+            {
+                /* full scale noise and quiet noise */
+                sigRef[n].s16 = (t & 1) ? (int16_t)rand() : (int16_t)(rand() % 2000 - 1000);
+                sigDut[n] = sigRef[n];
+            }
+
+            Filter_Biquad_Process_Buffer_Ref(sigRef, &ref, CHECK_BLOCK_LEN);
+            Filter_Biquad_Process_Buffer(sigDut, &dut, CHECK_BLOCK_LEN);
+
+            for (int n = 0; n < CHECK_BLOCK_LEN; n++)
+            {
+                total++;
+                diff += (sigRef[n].s16 != sigDut[n].s16) ? 1 : 0;
+            }
+        }
+    }
+
+#ifdef __ARM_FEATURE_DSP
+    printf("Filter_Biquad_Process_Buffer (DSP): %ld samples, %ld different\n", total, diff);
+#else
+    printf("Filter_Biquad_Process_Buffer: %ld samples, %ld different\n", total, diff);
+#endif
+
+    return (diff == 0) ? 0 : 1;
+}
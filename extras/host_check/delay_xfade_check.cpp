@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file delay_xfade_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of the clicks when the delay time is changed
+ * A 220 Hz sine is fed into the legacy delay and into ML_Delay.
+ * After one second the delay time jumps from 300 ms to 212.4 ms,
+ * after two seconds it is swept from 200 ms to 300 ms within 0.5 s (one change per block).
+ * The energy of the second difference of the output is compared to the steady state,
+ * a clean transition stays at about 1x.
+ * Build with -DML_DELAY_XFADE=1 to compare with a hard switch of the read head.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_delay.h"
+
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+
+#define SAMPLE_RATE     44100
+#define LINE_LEN        44100
+#define BLOCK_LEN       48
+#define WINDOW_LEN      4096
+
+
+static int16_t line_l[LINE_LEN];
+static int16_t line_r[LINE_LEN];
+
+
+/*
+ * energy of the second difference of y[a..b-1]
+ */
+static double D2Energy(const std::vector<float> &y, size_t a, size_t b)
+{
+    double e = 0;
+    for (size_t i = a + 2; i < b; i++)
+    {
+        double d = y[i] - 2.0 * y[i - 1] + y[i - 2];
+        e += d * d;
+    }
+    return e;
+}
+
+/*
+ * returns the ratio of the step change to the steady state, the sweep ratio is written to sweepRatio
+ */
+static double Measure(bool legacy, double *sweepRatio)
+{
+    std::vector<float> out;
+    size_t changeAt = 0;
+    size_t sweepAt = 0;
+    double phase = 0;
+
+    ML_Delay delay(SAMPLE_RATE, line_l, line_r, LINE_LEN);
+    delay.setTap(0, 0.3f, 1.0f, 0.5f);
+
+    if (legacy)
+    {
+        Delay_Init2(line_l, line_r, LINE_LEN);
+        Delay_SetLength(0, (uint32_t)(0.3f * SAMPLE_RATE));
+        Delay_SetOutputLevel(0, 1.0f);
+        Delay_SetInputLevel(0, 0.5f);
+    }
+
+    for (uint32_t s = 0; s < 3 * SAMPLE_RATE; s += BLOCK_LEN)
+    {
+        float in_l[BLOCK_LEN], in_r[BLOCK_LEN];
+        float out_l[BLOCK_LEN] = {0}, out_r[BLOCK_LEN] = {0};
+
+        for (uint32_t i = 0; i < BLOCK_LEN; i++)
+        {
+            in_l[i] = in_r[i] = 0.5f * sinf(phase);
+            phase += 2.0 * M_PI * 220.0 / SAMPLE_RATE;
+        }
+
+        float time = -1.0f;
+        if ((s >= SAMPLE_RATE) && (changeAt == 0))
+        {
+            changeAt = s;
+            time = 0.2124f;
+        }
+        if ((s >= 2 * SAMPLE_RATE) && (s < 2.5f * SAMPLE_RATE))
+        {
+            sweepAt = (sweepAt == 0) ? s : sweepAt;
+            time = 0.2f + 0.1f * (s - 2 * SAMPLE_RATE) / (0.5f * SAMPLE_RATE);
+        }
+        if (time > 0.0f)
+        {
+            if (legacy)
+            {
+                Delay_SetLength(0, (uint32_t)(time * SAMPLE_RATE));
+            }
+            else
+            {
+                delay.setTapTime(0, time);
+            }
+        }
+
+        if (legacy)
+        {
+            /* the legacy delay adds the dry signal, it is removed again */
+            for (uint32_t i = 0; i < BLOCK_LEN; i++)
+            {
+                out_l[i] = in_l[i];
+                out_r[i] = in_r[i];
+            }
+            Delay_Process_Buff2(out_l, out_r, BLOCK_LEN);
+            for (uint32_t i = 0; i < BLOCK_LEN; i++)
+            {
+                out_l[i] -= in_l[i];
+            }
+        }
+        else
+        {
+            delay.Process(in_l, in_r, out_l, out_r, BLOCK_LEN);
+        }
+
+        out.insert(out.end(), out_l, out_l + BLOCK_LEN);
+    }
+
+    const double base = D2Energy(out, changeAt - WINDOW_LEN - 100, changeAt - 100);
+    const double step = D2Energy(out, changeAt - 2, changeAt - 2 + WINDOW_LEN);
+    const double sweep = D2Energy(out, sweepAt - 2, sweepAt - 2 + SAMPLE_RATE / 2) / ((SAMPLE_RATE / 2.0) / WINDOW_LEN);
+
+    *sweepRatio = sweep / base;
+    return step / base;
+}
+
+int main(void)
+{
+    double legacyStep, legacySweep, step, sweep;
+
+    legacyStep = Measure(true, &legacySweep);
+    step = Measure(false, &sweep);
+
+    printf("second difference energy relative to steady state (ML_DELAY_XFADE %d)\n", ML_DELAY_XFADE);
+    printf("  legacy Delay_SetLength: step %.1fx, sweep %.1fx\n", legacyStep, legacySweep);
+    printf("  ML_Delay:               step %.1fx, sweep %.1fx\n", step, sweep);
+
+#if ML_DELAY_XFADE > 1
+    return ((step < 2.0) && (sweep < 2.0)) ? 0 : 1;
+#else
+    return 0;
+#endif
+}
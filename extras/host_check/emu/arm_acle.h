@@ -0,0 +1,40 @@
+/*
+ * scalar emulation of the ACLE DSP intrinsics used in the library
+ * - allows to run the __ARM_FEATURE_DSP code paths on the host (compile with -Iemu -D__ARM_FEATURE_DSP)
+ * - the accumulation wraps around like on the target (smlad only sets the Q flag on overflow)
+ */
+#ifndef ARM_ACLE_EMU_H_
+#define ARM_ACLE_EMU_H_
+
+#include <stdint.h>
+
+/* bottom half of a, top half of b shifted left by s */
+static inline uint32_t __pkhbt(uint32_t a, uint32_t b, int s)
+{
+    return (a & 0xFFFFu) | ((b << s) & 0xFFFF0000u);
+}
+
+/* c + a.lo * b.lo + a.hi * b.hi */
+static inline int32_t __smlad(uint32_t a, uint32_t b, int32_t c)
+{
+    const int32_t lo = (int16_t)a * (int16_t)b;
+    const int32_t hi = (int16_t)(a >> 16) * (int16_t)(b >> 16);
+    return (int32_t)((uint32_t)c + (uint32_t)lo + (uint32_t)hi);
+}
+
+/* c + a.lo * b.lo */
+static inline int32_t __smlabb(int32_t a, int32_t b, int32_t c)
+{
+    const int32_t lo = (int16_t)a * (int16_t)b;
+    return (int32_t)((uint32_t)c + (uint32_t)lo);
+}
+
+/* saturate v to a signed n bit value */
+static inline int32_t __ssat(int32_t v, int n)
+{
+    const int32_t max = (1L << (n - 1)) - 1;
+    const int32_t min = -(1L << (n - 1));
+    return (v > max) ? max : ((v < min) ? min : v);
+}
+
+#endif /* ARM_ACLE_EMU_H_ */
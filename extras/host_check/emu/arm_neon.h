@@ -0,0 +1,66 @@
+/*
+ * scalar emulation of the NEON intrinsics used in the library
+ * - allows to run the NEON code paths on the host (compile with -Iemu -D__ARM_NEON -U__SSE__)
+ * - each lane is rounded separately without fused multiply add like vaddq_f32/vmulq_f32 on the target
+ */
+#ifndef ARM_NEON_EMU_H_
+#define ARM_NEON_EMU_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+    float v[4];
+} float32x4_t;
+
+static inline float32x4_t vld1q_f32(const float *p)
+{
+    float32x4_t r;
+    for (int i = 0; i < 4; i++)
+    {
+        r.v[i] = p[i];
+    }
+    return r;
+}
+
+static inline void vst1q_f32(float *p, float32x4_t a)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = a.v[i];
+    }
+}
+
+static inline float32x4_t vaddq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t r;
+    for (int i = 0; i < 4; i++)
+    {
+        r.v[i] = a.v[i] + b.v[i];
+    }
+    return r;
+}
+
+static inline float32x4_t vsubq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t r;
+    for (int i = 0; i < 4; i++)
+    {
+        r.v[i] = a.v[i] - b.v[i];
+    }
+    return r;
+}
+
+static inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b)
+{
+    float32x4_t r;
+    for (int i = 0; i < 4; i++)
+    {
+        r.v[i] = a.v[i] * b.v[i];
+    }
+    return r;
+}
+
+#define vgetq_lane_f32(a, lane)     ((a).v[(lane)])
+
+#endif /* ARM_NEON_EMU_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file filter_bank_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of Filter_Bank_Process_Buffer against Filter_Process_Buffer
+ * Each lane of the bank has to be bit exact to a single filter with the same coefficients.
+ * The lane count selects the code path: FILTER_BANK_LANES 4 or 8 uses SSE on x86 (NEON with emu/arm_neon.h),
+ * any other count the scalar version.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_filter.h"
+#include "ml_waveform.h"
+
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define CHECK_BLOCK_LEN     256
+#define CHECK_BLOCK_CNT     100
+#define BENCH_BLOCK_LEN     48
+#define BENCH_BLOCK_CNT     100000
+
+
+static float sineTab[WAVEFORM_CNT];
+float *sine = sineTab;
+
+static struct filterCoeffT filterC[FILTER_BANK_LANES];
+static struct filterProcT filterP[FILTER_BANK_LANES];
+static struct filterBankT bank;
+static float ref[FILTER_BANK_LANES][CHECK_BLOCK_LEN];
+static float buf[FILTER_BANK_LANES][CHECK_BLOCK_LEN];
+
+
+int main(void)
+{
+    float *signal[FILTER_BANK_LANES];
+
+    for (int i = 0; i < WAVEFORM_CNT; i++)
+    {
+        sineTab[i] = sinf(i * 2.0f * (float)M_PI / WAVEFORM_CNT);
+    }
+
+    Filter_Bank_Init(&bank, &filterC[0]);
+    for (int l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        Filter_Init(&filterP[l], &filterC[l]);
+        Filter_CalculateLowPass(0.2f + 0.1f * (l % 7), 0.7f + l, &filterC[l]);
+        Filter_Bank_SetCoeff(&bank, l, &filterC[l]);
+        signal[l] = buf[l];
+    }
+
+    srand(1);
+    int mismatch = 0;
+    for (int blk = 0; blk < CHECK_BLOCK_CNT; blk++)
+    {
+        for (int l = 0; l < FILTER_BANK_LANES; l++)
+        {
+            for (int n = 0; n < CHECK_BLOCK_LEN; n++)
+            {
+                ref[l][n] = buf[l][n] = (rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+            }
+            Filter_Process_Buffer(ref[l], &filterP[l], CHECK_BLOCK_LEN);
+        }
+        Filter_Bank_Process_Buffer(signal, &bank, CHECK_BLOCK_LEN);
+        mismatch += (memcmp(ref, buf, sizeof(ref)) != 0) ? 1 : 0;
+    }
+    printf("lanes %d: %d of %d blocks mismatching\n", FILTER_BANK_LANES, mismatch, CHECK_BLOCK_CNT);
+
+    double single = 1e9, banked = 1e9;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < BENCH_BLOCK_CNT; k++)
+        {
+            for (int l = 0; l < FILTER_BANK_LANES; l++)
+            {
+                Filter_Process_Buffer(ref[l], &filterP[l], BENCH_BLOCK_LEN);
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int k = 0; k < BENCH_BLOCK_CNT; k++)
+        {
+            Filter_Bank_Process_Buffer(signal, &bank, BENCH_BLOCK_LEN);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        single = fmin(single, std::chrono::duration<double>(t1 - t0).count());
+        banked = fmin(banked, std::chrono::duration<double>(t2 - t1).count());
+    }
+    const double scale = 1e9 / BENCH_BLOCK_CNT / BENCH_BLOCK_LEN / FILTER_BANK_LANES;
+    printf("  ns per sample and lane: Filter_Process_Buffer %.2f, Filter_Bank_Process_Buffer %.2f\n", single * scale, banked * scale);
+
+    return (mismatch == 0) ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file filter_table_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of Filter_CoeffTable_Lookup against Filter_CalculateLowPass
+ * The magnitude response of both is compared at 199 frequencies for 20000 random settings
+ * (cutoff 0.05..1, resonance 0.5..8), only where the response is above -40 dB.
+ * The design itself takes cos and sin from the sine table, both are also compared against
+ * the same design calculated with cos and sin in double precision.
+ * The check fails when the p99.9 error against the design exceeds CHECK_P999_DB.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_filter.h"
+#include "ml_waveform.h"
+
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+
+#define CHECK_SETTING_CNT   20000
+#define CHECK_FREQ_CNT      200
+#define CHECK_P999_DB       4.0
+#define RESO_MIN            0.5f
+#define RESO_MAX            8.0f
+#define BENCH_CNT           1000000
+
+
+static float sineTab[WAVEFORM_CNT];
+float *sine = sineTab;
+
+
+static double MagDb(const struct filterCoeffT *c, double w)
+{
+    const std::complex<double> z = std::polar(1.0, -w);
+    const std::complex<double> num = (double)c->bNorm[0] + (double)c->bNorm[1] * z + (double)c->bNorm[2] * z * z;
+    const std::complex<double> den = 1.0 + (double)c->aNorm[0] * z + (double)c->aNorm[1] * z * z;
+    return 20.0 * log10(std::abs(num / den) + 1e-30);
+}
+
+/*
+ * Filter_CalculateLowPass with cos and sin in double precision
+ */
+static void CalculateLowPassExact(float c, float reso, struct filterCoeffT *const filterC)
+{
+    double omega = (double)c * c * c;
+    omega = (omega >= 1.0) ? 1.0 : ((omega < 0.0025) ? 0.0025 : omega);
+    const double w = M_PI * omega;
+    const double alpha = sin(w) / (2.0 * reso);
+    const double factor = 1.0 / (1.0 + alpha);
+
+    filterC->aNorm[0] = -2.0 * cos(w) * factor;
+    filterC->aNorm[1] = (1.0 - alpha) * factor;
+    filterC->bNorm[0] = (1.0 - cos(w)) / 2.0 * factor;
+    filterC->bNorm[1] = (1.0 - cos(w)) * factor;
+    filterC->bNorm[2] = filterC->bNorm[0];
+}
+
+static void PrintError(const char *name, std::vector<double> &err)
+{
+    double sum = 0;
+    for (double e : err)
+    {
+        sum += e;
+    }
+    std::sort(err.begin(), err.end());
+    printf("  %-28s mean %.3f dB, p99 %.3f dB, p99.9 %.3f dB, max %.2f dB\n", name, sum / err.size(),
+           err[err.size() * 99 / 100], err[err.size() * 999 / 1000], err.back());
+}
+
+int main(void)
+{
+    struct filterCoeffTableT table;
+    std::vector<double> errDesign, errExact, errDesignExact;
+
+    for (int i = 0; i < WAVEFORM_CNT; i++)
+    {
+        sineTab[i] = sinf(i * 2.0f * (float)M_PI / WAVEFORM_CNT);
+    }
+
+    if (!Filter_CoeffTable_Init(&table, Filter_CalculateLowPass, RESO_MIN, RESO_MAX))
+    {
+        return 1;
+    }
+
+    srand(2);
+    for (int k = 0; k < CHECK_SETTING_CNT; k++)
+    {
+        const float c = 0.05f + 0.95f * rand() / (float)RAND_MAX;
+        const float reso = RESO_MIN + (RESO_MAX - RESO_MIN) * rand() / (float)RAND_MAX;
+        struct filterCoeffT design, exact, lookup;
+
+        Filter_CalculateLowPass(c, reso, &design);
+        CalculateLowPassExact(c, reso, &exact);
+        Filter_CoeffTable_Lookup(&table, c, reso, &lookup);
+
+        for (int f = 1; f < CHECK_FREQ_CNT; f++)
+        {
+            const double w = M_PI * f / CHECK_FREQ_CNT;
+            const double refDesign = MagDb(&design, w);
+            const double refExact = MagDb(&exact, w);
+            const double val = MagDb(&lookup, w);
+
+            if (refDesign >= -40.0)
+            {
+                errDesign.push_back(fabs(val - refDesign));
+            }
+            if (refExact >= -40.0)
+            {
+                errExact.push_back(fabs(val - refExact));
+                errDesignExact.push_back(fabs(refDesign - refExact));
+            }
+        }
+    }
+
+    printf("magnitude response error, %d x %d table, resonance %.1f..%.1f\n", FILTER_TABLE_CUTOFF_CNT, FILTER_TABLE_RESO_CNT, RESO_MIN, RESO_MAX);
+    PrintError("lookup vs design:", errDesign);
+    PrintError("lookup vs exact design:", errExact);
+    PrintError("design vs exact design:", errDesignExact);
+
+    volatile float sink = 0;
+    struct filterCoeffT out;
+    double design = 1e9, lookup = 1e9;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < BENCH_CNT; k++)
+        {
+            Filter_CalculateLowPass(0.1f + k * 1e-7f, 0.7f + k * 1e-6f, &out);
+            sink = sink + out.coef[0];
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int k = 0; k < BENCH_CNT; k++)
+        {
+            Filter_CoeffTable_Lookup(&table, 0.1f + k * 1e-7f, 0.7f + k * 1e-6f, &out);
+            sink = sink + out.coef[0];
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        design = fmin(design, std::chrono::duration<double>(t1 - t0).count());
+        lookup = fmin(lookup, std::chrono::duration<double>(t2 - t1).count());
+    }
+    printf("  ns per update on the host: Filter_CalculateLowPass %.1f, Filter_CoeffTable_Lookup %.1f\n", design * 1e9 / BENCH_CNT, lookup * 1e9 / BENCH_CNT);
+
+    return (errDesign[errDesign.size() * 999 / 1000] <= CHECK_P999_DB) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fm_alg_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of the algorithm specific voice renderers against FM_ALG_REFERENCE
+ * All 8 algorithms are played with feedback (three notes, 0.2 s held, 0.1 s release).
+ * The default build writes the output to a file, the build with FM_ALG_REFERENCE
+ * (generic switch based mixing) renders the same and fails on any difference.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_fm.h"
+
+
+#include <stdio.h>
+#include <string.h>
+
+
+#define SAMPLE_RATE     44100
+#define BLOCK_LEN       48
+#define NOTE_LEN        (BLOCK_LEN * 184)
+#define ALG_LEN         (BLOCK_LEN * 276)
+
+
+static struct synthVoice_s voices[FM_VOICE_CNT];
+static FmEngine engine;
+static float algOut[8][ALG_LEN];
+
+
+static void Render(void)
+{
+    static const uint8_t notes[3] = {45, 57, 64};
+
+    engine.Init(SAMPLE_RATE, voices, FM_VOICE_CNT);
+
+    for (int algo = 0; algo < 8; algo++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            engine.NoteOn(algo, notes[i], 0.5f + 0.2f * i);
+        }
+        engine.SetAlgorithm(algo, 1.0f);
+        engine.Feedback(0, 0.1f + 0.1f * algo);
+
+        for (int n = 0; n < ALG_LEN; n += BLOCK_LEN)
+        {
+            if (n == NOTE_LEN)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    engine.NoteOff(algo, notes[i]);
+                }
+            }
+            float out[2 * BLOCK_LEN];
+            engine.Process(NULL, out, BLOCK_LEN);
+            memcpy(&algOut[algo][n], out, sizeof(float) * BLOCK_LEN);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: %s <output file of the default build>\n", argv[0]);
+        return 1;
+    }
+
+    Render();
+
+#ifndef FM_ALG_REFERENCE
+    FILE *f = fopen(argv[1], "wb");
+    bool ok = (f != NULL) && (fwrite(algOut, sizeof(algOut), 1, f) == 1);
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+    printf("output written to %s\n", argv[1]);
+    return ok ? 0 : 1;
+#else
+    static float ref[8][ALG_LEN];
+    FILE *f = fopen(argv[1], "rb");
+    if ((f == NULL) || (fread(ref, sizeof(ref), 1, f) != 1))
+    {
+        printf("could not read %s, run the default build first\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    int failed = 0;
+    printf("FM_ALG_REFERENCE against the algorithm specific renderers\n");
+    for (int algo = 0; algo < 8; algo++)
+    {
+        int diff = 0;
+        for (int n = 0; n < ALG_LEN; n++)
+        {
+            diff += memcmp(&algOut[algo][n], &ref[algo][n], sizeof(float)) != 0;
+        }
+        printf("  algorithm %d: %d of %d samples differ\n", algo, diff, ALG_LEN);
+        failed += diff != 0;
+    }
+
+    return (failed == 0) ? 0 : 1;
+#endif
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fm_bench.cpp
+ * @author Marcel Licence
+ *
+ * @brief Samples per second of the FM voice renderer on the host
+ * FM_BENCH_VOICES sustained voices are rendered for BENCH_LEN samples in blocks of 48,
+ * the best of BENCH_REPEAT runs is printed.
+ * With FM_BENCH_BEFORE the program is built against the baseline ml_fm.cpp
+ * (fixed voice count, only FmSynth_Init without voice memory), see the Makefile.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_fm.h"
+
+
+#include <chrono>
+#include <stdio.h>
+
+
+#ifndef FM_BENCH_VOICES
+#define FM_BENCH_VOICES 6
+#endif
+
+#define SAMPLE_RATE     44100
+#define BLOCK_LEN       48
+#define BENCH_LEN       SAMPLE_RATE
+#define BENCH_REPEAT    5
+
+
+#ifndef FM_BENCH_BEFORE
+static struct synthVoice_s voices[FM_BENCH_VOICES];
+#endif
+
+
+int main(void)
+{
+    float out[2 * BLOCK_LEN];
+    double best = 1e30;
+
+    for (int r = 0; r < BENCH_REPEAT; r++)
+    {
+#ifdef FM_BENCH_BEFORE
+        FmSynth_Init(SAMPLE_RATE);
+#else
+        FmSynth_Init(SAMPLE_RATE, voices, FM_BENCH_VOICES);
+#endif
+        for (int v = 0; v < FM_BENCH_VOICES; v++)
+        {
+            FmSynth_NoteOn(1, 36 + 2 * v, 0.8f); /* patch 1 sustains */
+        }
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int n = 0; n < BENCH_LEN; n += BLOCK_LEN)
+        {
+            FmSynth_Process(NULL, out, BLOCK_LEN);
+        }
+        const auto t1 = std::chrono::steady_clock::now();
+
+        const double t = std::chrono::duration<double>(t1 - t0).count();
+        best = (t < best) ? t : best;
+    }
+
+#ifdef FM_BENCH_BEFORE
+    printf("  before, %2d voices: %6.2f Msamples/s\n", FM_BENCH_VOICES, BENCH_LEN / best * 1e-6);
+#else
+    printf("  after,  %2d voices: %6.2f Msamples/s\n", FM_BENCH_VOICES, BENCH_LEN / best * 1e-6);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fm_env_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of the integer envelope of ml_fm.cpp
+ * ml_fm.cpp is included to reach the static tables and functions.
+ * The tables are compared against their formulas, then the envelope of one operator
+ * is rendered through FmSynth_ProcessVoiceChunk and FmSynth_EnvStateProcess for
+ * several ar/d1r/d2r/rr/rs/ks settings and for every ssg-eg mode.
+ * The audible attenuation (10 bit, 64 steps are 6 dB) is taken every ENV_STEP samples
+ * and compared against the stored golden arrays, the note is released at ENV_NOTE_OFF.
+ * Build with -DFM_ENV_GOLDEN to print the arrays of the current code.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_fm.cpp"
+
+
+#include <math.h>
+#include <stdio.h>
+
+
+#define ENV_POINTS      64
+#define ENV_STEP        128
+#define ENV_NOTE_OFF    48 /* point of the note off */
+
+
+struct envCase_s
+{
+    const char *name;
+    uint32_t ar;
+    uint32_t d1r;
+    float d2l;
+    uint32_t d2r;
+    uint32_t rr;
+    uint32_t rs;
+    uint8_t ks;
+    uint8_t ssgeg;
+    uint8_t note;
+};
+
+static const struct envCase_s envCases[] =
+{
+    { "fast attack, decay, release", 1, 40, 0.5f, 100, 30, 50, 0, ssgeg_off, 60 },
+    { "slow attack", 100, 20, 0.25f, 400, 10, 50, 0, ssgeg_off, 60 },
+    { "rs 10", 400, 100, 0.7f, 300, 150, 10, 0, ssgeg_off, 60 },
+    { "ks 1 at note 96", 100, 400, 0.5f, 1000, 300, 50, 1, ssgeg_off, 96 },
+    { "ks 3 at note 72", 100, 400, 0.5f, 1000, 300, 50, 3, ssgeg_off, 72 },
+    { "sustain, instant release", 1, 32767, 1.0f, 32767, 1, 50, 0, ssgeg_off, 60 },
+    { "ssg-eg repeat", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_repeat, 60 },
+    { "ssg-eg once", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_once, 60 },
+    { "ssg-eg mirror", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_mirror, 60 },
+    { "ssg-eg once high", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_once_high, 60 },
+    { "ssg-eg loop reverse", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_loop_rev, 60 },
+    { "ssg-eg once inverted", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_once_inv, 60 },
+    { "ssg-eg mirror inverted", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_mirro_inv, 60 },
+    { "ssg-eg once high inverted", 1, 160, 0.5f, 160, 20, 50, 0, ssgeg_once_high_inv, 60 },
+};
+
+#define ENV_CASE_CNT    (sizeof(envCases) / sizeof(envCases[0]))
+
+/* attenuation every ENV_STEP samples, generated with FM_ENV_GOLDEN */
+static const uint16_t envGolden[ENV_CASE_CNT][ENV_POINTS] =
+{
+    /* fast attack, decay, release */
+    {
+        39, 80, 106, 132, 158, 184, 210, 235, 261, 287, 313, 339, 365, 391, 417, 443,
+        469, 495, 521, 547, 572, 598, 624, 650, 676, 702, 728, 754, 780, 806, 832, 858,
+        884, 909, 935, 961, 987, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* slow attack */
+    {
+        858, 720, 604, 506, 425, 356, 299, 251, 210, 176, 148, 124, 104, 87, 73, 61,
+        51, 43, 36, 30, 25, 21, 18, 15, 12, 10, 8, 7, 6, 5, 4, 3,
+        3, 2, 2, 1, 1, 1, 1, 128, 134, 141, 147, 154, 160, 166, 173, 179,
+        440, 700, 960, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* rs 10 */
+    {
+        820, 658, 528, 424, 340, 272, 219, 175, 141, 113, 90, 72, 58, 46, 37, 30,
+        24, 19, 15, 12, 10, 8, 6, 5, 4, 3, 2, 2, 1, 1, 1, 57,
+        100, 144, 187, 231, 275, 318, 362, 405, 449, 492, 536, 580, 623, 667, 710, 754,
+        841, 928, 1015, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ks 1 at note 96 */
+    {
+        562, 309, 170, 93, 51, 28, 15, 8, 4, 2, 1, 9, 31, 53, 68, 77,
+        86, 95, 103, 112, 121, 130, 139, 147, 156, 165, 174, 183, 192, 200, 209, 218,
+        227, 236, 245, 253, 262, 271, 280, 289, 298, 306, 315, 324, 333, 342, 351, 359,
+        389, 418, 447, 476, 506, 535, 564, 593, 623, 652, 681, 710, 740, 769, 798, 827,
+    },
+    /* ks 3 at note 72 */
+    {
+        3, 103, 186, 270, 353, 437, 521, 604, 688, 771, 855, 939, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* sustain, instant release */
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg repeat */
+    {
+        39, 105, 170, 235, 300, 365, 430, 495, 28, 93, 158, 223, 289, 354, 419, 484,
+        17, 82, 147, 212, 277, 342, 407, 472, 6, 71, 136, 201, 266, 331, 396, 461,
+        2, 59, 125, 190, 255, 320, 385, 450, 64, 48, 114, 179, 244, 309, 374, 439,
+        569, 699, 829, 959, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg once */
+    {
+        39, 105, 170, 235, 300, 365, 430, 495, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg mirror */
+    {
+        39, 105, 170, 235, 300, 365, 430, 495, 484, 419, 354, 289, 223, 158, 93, 28,
+        17, 82, 147, 212, 277, 342, 407, 472, 506, 441, 376, 311, 246, 181, 116, 51,
+        2, 59, 125, 190, 255, 320, 385, 450, 448, 464, 398, 333, 268, 203, 138, 73,
+        203, 333, 463, 593, 723, 853, 983, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg once high */
+    {
+        39, 105, 170, 235, 300, 365, 430, 495, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        130, 260, 390, 520, 650, 780, 910, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg loop reverse */
+    {
+        473, 407, 342, 277, 212, 147, 82, 17, 484, 419, 354, 289, 223, 158, 93, 28,
+        495, 430, 365, 300, 235, 170, 105, 40, 506, 441, 376, 311, 246, 181, 116, 51,
+        510, 453, 387, 322, 257, 192, 127, 62, 448, 464, 398, 333, 268, 203, 138, 73,
+        203, 333, 463, 593, 723, 853, 983, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg once inverted */
+    {
+        473, 407, 342, 277, 212, 147, 82, 17, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        130, 260, 390, 520, 650, 780, 910, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg mirror inverted */
+    {
+        473, 407, 342, 277, 212, 147, 82, 17, 28, 93, 158, 223, 289, 354, 419, 484,
+        495, 430, 365, 300, 235, 170, 105, 40, 6, 71, 136, 201, 266, 331, 396, 461,
+        510, 453, 387, 322, 257, 192, 127, 62, 64, 48, 114, 179, 244, 309, 374, 439,
+        569, 699, 829, 959, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+    /* ssg-eg once high inverted */
+    {
+        473, 407, 342, 277, 212, 147, 82, 17, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+        1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    },
+};
+
+
+/*
+ * compares the tables against their formulas, returns the number of wrong entries
+ */
+static int CheckTables(void)
+{
+    int err = 0;
+
+    for (int i = 0; i < 64; i++)
+    {
+        err += fmEgPow2[i] != (uint16_t)lround(32768.0 * pow(2.0, -i / 64.0));
+        err += fmEgRecip[i] != (uint16_t)floor(32768.0 / (1.0 + (i + 1) / 64.0));
+        err += fmEgLog2[i] != (uint8_t)lround(64.0 * log2(1.0 + i / 64.0));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        err += fmEgKeyScale[i] != (uint16_t)lround(256.0 * pow(2.0, -i / 4.0));
+    }
+
+    return err;
+}
+
+/*
+ * renders the envelope of one case, the operators are processed like ProcessVoice does
+ */
+static void RenderCase(const struct envCase_s *c, uint16_t *att)
+{
+    static struct channelSettingParam_s setting;
+    static struct synthVoice_s voice;
+    struct op_properties_s *op_prop = &setting.op_prop[0];
+    fm_sample_t out[ENV_STEP];
+
+    Sine_Init();
+    FmSynth_InitChannelSettings(&setting);
+    setting.algo = 7;
+
+    op_prop->ar = c->ar;
+    op_prop->d1r = c->d1r;
+    op_prop->d2l = c->d2l;
+    op_prop->d2r = c->d2r;
+    op_prop->rr = c->rr;
+    op_prop->rs = c->rs;
+    op_prop->ks = c->ks;
+    op_prop->ssgeg = c->ssgeg;
+
+    memset(&voice, 0, sizeof(voice));
+    voice.settings = &setting;
+    voice.midiNote = c->note;
+    voice.active = true;
+    for (int i = 0; i < 4; i++)
+    {
+        FmSynth_ToneInit(&voice, i, op_prop);
+    }
+
+    for (int p = 0; p < ENV_POINTS; p++)
+    {
+        if (p == ENV_NOTE_OFF)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                if (voice.state[i] != ENV_OFF)
+                {
+                    voice.state[i] = ENV_RELEASE;
+                    FmSynth_ToneEnvUpdate(&voice, i);
+                }
+            }
+        }
+
+        uint32_t n = 0;
+        while (voice.active && (n < ENV_STEP))
+        {
+            uint32_t chunkLen = ENV_STEP - n;
+            for (int i = 0; i < 4; i++)
+            {
+                if ((voice.state[i] != ENV_OFF) && ((uint32_t)voice.stateLen[i] < chunkLen))
+                {
+                    chunkLen = voice.stateLen[i];
+                }
+            }
+            FmSynth_ProcessVoiceChunk<7>(&voice, &out[n], chunkLen, 1);
+            n += chunkLen;
+            voice.active = FmSynth_EnvStateProcess(&voice, chunkLen);
+        }
+
+        /* audible attenuation, same as FmSynth_ProcessOperator */
+        uint32_t idx = voice.eg_att[0] >> FM_EG_FRAC;
+        idx = (idx < FM_EG_MSK) ? idx : FM_EG_MSK;
+        att[p] = voice.ssgInv[0] ? ((0x200 - idx) & FM_EG_MSK) : idx;
+    }
+}
+
+int main(void)
+{
+    int tableErr = CheckTables();
+    int caseErr = 0;
+
+    printf("envelope tables: %d wrong entries\n", tableErr);
+
+    for (uint32_t c = 0; c < ENV_CASE_CNT; c++)
+    {
+        uint16_t att[ENV_POINTS];
+
+        RenderCase(&envCases[c], att);
+
+#ifdef FM_ENV_GOLDEN
+        printf("    /* %s */\n    {\n", envCases[c].name);
+        for (int p = 0; p < ENV_POINTS; p++)
+        {
+            printf("%s%d,%s", (p % 16) ? " " : "        ", att[p], ((p % 16) == 15) ? "\n" : "");
+        }
+        printf("    },\n");
+#else
+        int diff = 0;
+        for (int p = 0; p < ENV_POINTS; p++)
+        {
+            diff += att[p] != envGolden[c][p];
+        }
+        printf("  %-32s %s", envCases[c].name, diff ? "differs:" : "ok\n");
+        if (diff)
+        {
+            for (int p = 0; p < ENV_POINTS; p++)
+            {
+                printf(" %d", att[p]);
+            }
+            printf("\n");
+        }
+        caseErr += diff != 0;
+#endif
+    }
+
+    return ((tableErr == 0) && (caseErr == 0)) ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fm_fixed_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of the FM_FIXED_POINT_ENABLED render path against the float path
+ * Every patch of the preset bank is played on its own channel (two notes, 0.5 s held,
+ * 0.3 s release), the feedback is limited to CHECK_FEEDBACK_MAX.
+ * The float build writes the output to a file, the fixed point build renders the same
+ * and compares, the check fails when the SNR of a patch is below CHECK_SNR_DB.
+ * High feedback amplifies the quantisation within the feedback loop, both outputs
+ * would drift apart.
+ * ml_fm.cpp is included to reach the feedback of the preset bank.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_fm.cpp"
+
+
+#include <math.h>
+#include <stdio.h>
+
+
+#define SAMPLE_RATE         44100
+#define BLOCK_LEN           48
+#define NOTE_LEN            (SAMPLE_RATE / 2)
+#define PATCH_LEN           (NOTE_LEN + (SAMPLE_RATE * 3) / 10)
+#define CHECK_FEEDBACK_MAX  0.3f
+#define CHECK_SNR_DB        50.0
+
+
+static struct synthVoice_s voices[FM_VOICE_CNT];
+static FmEngine engine;
+static float patchOut[MIDI_CH_CNT][PATCH_LEN];
+
+
+static void Render(void)
+{
+    engine.Init(SAMPLE_RATE, voices, FM_VOICE_CNT);
+
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        const float feedback = fmBankDefault[ch].feedback / 127.0f;
+
+        engine.NoteOn(ch, 48, 0.8f);
+        engine.NoteOn(ch, 60, 0.6f);
+        engine.Feedback(0, (feedback < CHECK_FEEDBACK_MAX) ? feedback : CHECK_FEEDBACK_MAX);
+
+        for (int n = 0; n < PATCH_LEN; n += BLOCK_LEN)
+        {
+            if (n == NOTE_LEN - (NOTE_LEN % BLOCK_LEN))
+            {
+                engine.NoteOff(ch, 48);
+                engine.NoteOff(ch, 60);
+            }
+            const int len = ((PATCH_LEN - n) < BLOCK_LEN) ? (PATCH_LEN - n) : BLOCK_LEN;
+            float out[2 * BLOCK_LEN];
+            engine.Process(NULL, out, len);
+            for (int i = 0; i < len; i++)
+            {
+                patchOut[ch][n + i] = out[i];
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("usage: %s <float output file>\n", argv[0]);
+        return 1;
+    }
+
+    Render();
+
+#ifndef FM_FIXED_POINT_ENABLED
+    FILE *f = fopen(argv[1], "wb");
+    bool ok = (f != NULL) && (fwrite(patchOut, sizeof(patchOut), 1, f) == 1);
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+    printf("float output written to %s\n", argv[1]);
+    return ok ? 0 : 1;
+#else
+    static float ref[MIDI_CH_CNT][PATCH_LEN];
+    FILE *f = fopen(argv[1], "rb");
+    if ((f == NULL) || (fread(ref, sizeof(ref), 1, f) != 1))
+    {
+        printf("could not read %s, run the float build first\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    double worst = 1000.0;
+    printf("fixed point against float, feedback limited to %.2f\n", CHECK_FEEDBACK_MAX);
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        double sig = 0.0, err = 0.0;
+        for (int n = 0; n < PATCH_LEN; n++)
+        {
+            const double d = (double)patchOut[ch][n] - ref[ch][n];
+            sig += (double)ref[ch][n] * ref[ch][n];
+            err += d * d;
+        }
+        const double snr = 10.0 * log10(sig / (err + 1e-30));
+        worst = (snr < worst) ? snr : worst;
+        printf("  patch %2d: %5.1f dB SNR\n", ch, snr);
+    }
+    printf("lowest %.1f dB, bound %.1f dB\n", worst, CHECK_SNR_DB);
+
+    return (worst >= CHECK_SNR_DB) ? 0 : 1;
+#endif
+}
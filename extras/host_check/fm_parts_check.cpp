@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fm_parts_check.cpp
+ * @author Marcel Licence
+ *
+ * @brief Host check of FmEngine::ProcessPart on multiple threads
+ * The same notes are rendered with FmSynth_Process and with an FmEngine instance which
+ * splits every block into 2 and 4 parts. Part 0 is rendered by the calling thread, the
+ * other parts by worker threads which wait for the next block.
+ * Per block: ProcessBegin, ProcessPart of every part, wait for all parts, ProcessEnd.
+ * NoteOn and NoteOff are only called between the blocks.
+ * The partial sums are added in a different order, the float build is compared with
+ * a tolerance of CHECK_MAX_DIFF, the fixed point build has to be identical.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_fm.h"
+
+
+#include <chrono>
+#include <condition_variable>
+#include <math.h>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+
+#define SAMPLE_RATE     44100
+#define BLOCK_LEN       48
+#define VOICE_CNT       32
+#define RENDER_LEN      (BLOCK_LEN * 2000)
+#define PART_MAX        4
+#ifdef FM_FIXED_POINT_ENABLED
+#define CHECK_MAX_DIFF  0.0f
+#else
+#define CHECK_MAX_DIFF  1e-6f
+#endif
+
+
+static struct synthVoice_s refVoices[VOICE_CNT];
+static struct synthVoice_s partVoices[VOICE_CNT];
+static FmEngine engine;
+static float refOut[RENDER_LEN];
+static float partOut[RENDER_LEN];
+
+/* worker threads, started once and woken up for every block */
+static float partial[PART_MAX][BLOCK_LEN];
+static float *partials[PART_MAX] = {partial[0], partial[1], partial[2], partial[3]};
+static std::mutex mtx;
+static std::condition_variable cvStart;
+static std::condition_variable cvDone;
+static uint32_t partCnt;
+static uint32_t generation;
+static uint32_t pending;
+static bool quit;
+
+
+static void Worker(uint32_t part)
+{
+    uint32_t seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cvStart.wait(lock, [&] { return quit || (generation != seen); });
+            if (quit)
+            {
+                return;
+            }
+            seen = generation;
+        }
+
+        engine.ProcessPart(part, partCnt, partials[part], BLOCK_LEN);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (--pending == 0)
+        {
+            cvDone.notify_one();
+        }
+    }
+}
+
+static void ProcessParts(float *out)
+{
+    engine.ProcessBegin(BLOCK_LEN);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pending = partCnt - 1;
+        generation++;
+    }
+    cvStart.notify_all();
+
+    engine.ProcessPart(0, partCnt, partials[0], BLOCK_LEN);
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cvDone.wait(lock, [] { return pending == 0; });
+    }
+
+    float stereo[2 * BLOCK_LEN];
+    engine.ProcessEnd(partials, partCnt, stereo, BLOCK_LEN);
+    for (int i = 0; i < BLOCK_LEN; i++)
+    {
+        out[i] = stereo[i];
+    }
+}
+
+/*
+ * plays overlapping notes on 4 channels, more notes than voices are started to test the voice stealing
+ */
+static void Events(uint32_t block, bool ref)
+{
+    const uint8_t ch = (block / 16) % 4;
+    const uint8_t note = 36 + (block / 16) % 48;
+
+    if ((block % 16) == 0)
+    {
+        ref ? FmSynth_NoteOn(ch, note, 0.7f) : engine.NoteOn(ch, note, 0.7f);
+    }
+    if ((block % 16) == 8)
+    {
+        ref ? FmSynth_NoteOn(ch, note + 7, 0.5f) : engine.NoteOn(ch, note + 7, 0.5f);
+    }
+    if ((block % 64) == 40)
+    {
+        ref ? FmSynth_NoteOff(ch, note) : engine.NoteOff(ch, note);
+    }
+}
+
+static double RenderRef(void)
+{
+    float stereo[2 * BLOCK_LEN];
+
+    FmSynth_Init(SAMPLE_RATE, refVoices, VOICE_CNT);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < RENDER_LEN / BLOCK_LEN; b++)
+    {
+        Events(b, true);
+        FmSynth_Process(NULL, stereo, BLOCK_LEN);
+        for (int i = 0; i < BLOCK_LEN; i++)
+        {
+            refOut[b * BLOCK_LEN + i] = stereo[i];
+        }
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+static double RenderParts(uint32_t cnt)
+{
+    std::thread workers[PART_MAX];
+
+    engine.Init(SAMPLE_RATE, partVoices, VOICE_CNT);
+
+    partCnt = cnt;
+    generation = 0;
+    quit = false;
+    for (uint32_t p = 1; p < partCnt; p++)
+    {
+        workers[p] = std::thread(Worker, p);
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < RENDER_LEN / BLOCK_LEN; b++)
+    {
+        Events(b, false);
+        ProcessParts(&partOut[b * BLOCK_LEN]);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        quit = true;
+    }
+    cvStart.notify_all();
+    for (uint32_t p = 1; p < partCnt; p++)
+    {
+        workers[p].join();
+    }
+
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+int main(void)
+{
+    static const uint32_t cnts[] = {2, 4};
+    int failed = 0;
+
+    const double refTime = RenderRef();
+
+    printf("%d voices, %d samples, %u hardware threads\n", VOICE_CNT, RENDER_LEN, std::thread::hardware_concurrency());
+    printf("  FmSynth_Process:   %7.1f ms\n", refTime);
+
+    for (uint32_t c : cnts)
+    {
+        const double t = RenderParts(c);
+        float maxDiff = 0.0f;
+
+        for (int n = 0; n < RENDER_LEN; n++)
+        {
+            const float d = fabsf(partOut[n] - refOut[n]);
+            maxDiff = (d > maxDiff) ? d : maxDiff;
+        }
+        printf("  %u parts / threads: %7.1f ms, max difference %g\n", c, t, maxDiff);
+        failed += maxDiff > CHECK_MAX_DIFF;
+    }
+
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Marcel Licence
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Dieses Programm ist Freie Software: Sie können es unter den Bedingungen
+ * der GNU General Public License, wie von der Free Software Foundation,
+ * Version 3 der Lizenz oder (nach Ihrer Wahl) jeder neueren
+ * veröffentlichten Version, weiter verteilen und/oder modifizieren.
+ *
+ * Dieses Programm wird in der Hoffnung bereitgestellt, dass es nützlich sein wird, jedoch
+ * OHNE JEDE GEWÄHR,; sogar ohne die implizite
+ * Gewähr der MARKTFÄHIGKEIT oder EIGNUNG FÜR EINEN BESTIMMTEN ZWECK.
+ * Siehe die GNU General Public License für weitere Einzelheiten.
+ *
+ * Sie sollten eine Kopie der GNU General Public License zusammen mit diesem
+ * Programm erhalten haben. Wenn nicht, siehe <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file fm_voice_time.cpp
+ * @author Marcel Licence
+ *
+ * @brief Render time per voice of the FM engine on the host
+ * FM_VOICE_CNT sustained voices are rendered for each algorithm (feedback 0.3),
+ * the best of TIME_REPEAT runs is printed as ns per voice and sample.
+ * Build with and without FM_FIXED_POINT_ENABLED to compare both render paths.
+ *
+ * @see Makefile
+ */
+
+
+#include "ml_fm.h"
+
+
+#include <chrono>
+#include <stdio.h>
+
+
+#define SAMPLE_RATE     44100
+#define BLOCK_LEN       48
+#define TIME_LEN        (SAMPLE_RATE / 4)
+#define TIME_REPEAT     5
+
+
+static struct synthVoice_s voices[FM_VOICE_CNT];
+static FmEngine engine;
+
+
+int main(void)
+{
+    float out[2 * BLOCK_LEN];
+
+#ifdef FM_FIXED_POINT_ENABLED
+    printf("fixed point, %d voices\n", FM_VOICE_CNT);
+#else
+    printf("float, %d voices\n", FM_VOICE_CNT);
+#endif
+
+    for (int algo = 0; algo < 8; algo++)
+    {
+        double best = 1e30;
+
+        for (int r = 0; r < TIME_REPEAT; r++)
+        {
+            engine.Init(SAMPLE_RATE, voices, FM_VOICE_CNT);
+            engine.SetAlgorithm(algo, 1.0f);
+            engine.Feedback(0, 0.3f);
+            for (int v = 0; v < FM_VOICE_CNT; v++)
+            {
+                engine.NoteOn(1, 48 + 5 * v, 0.8f); /* patch 1 sustains */
+            }
+
+            const auto t0 = std::chrono::steady_clock::now();
+            for (int n = 0; n < TIME_LEN; n += BLOCK_LEN)
+            {
+                engine.Process(NULL, out, BLOCK_LEN);
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+
+            const double t = std::chrono::duration<double, std::nano>(t1 - t0).count();
+            best = (t < best) ? t : best;
+        }
+
+        printf("  algorithm %d: %5.2f ns per voice and sample\n", algo, best / ((double)FM_VOICE_CNT * TIME_LEN));
+    }
+
+    return 0;
+}
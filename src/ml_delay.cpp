@@ -52,6 +52,7 @@
 
 
 #include <stdio.h>
+#include <string.h>
 
 
 /*
@@ -432,3 +433,588 @@ void Delay_SetShift(uint8_t unused __attribute__((unused)), float value)
     Status_ValueChangedFloat("Delay_SetShift", value);
 }
 
+/*
+ * ML_Delay
+ */
+float ML_Delay::muLawTable[256];
+bool ML_Delay::muLawTableReady = false;
+
+/*
+ * G.711 mu-law, 8 bit with 14 bit dynamic range
+ */
+static inline uint8_t Delay_MuLawEncode(int32_t x)
+{
+    uint8_t sign = 0;
+    if (x < 0)
+    {
+        x = -x;
+        sign = 0x80;
+    }
+    x = (x < 32635) ? x : 32635;
+    x += 0x84;
+
+    uint32_t exponent = 31 - __builtin_clz(x) - 7;
+    uint32_t mantissa = (x >> (exponent + 3)) & 0x0F;
+
+    return ~(sign | (exponent << 4) | mantissa);
+}
+
+static inline int16_t Delay_MuLawDecode(uint8_t u)
+{
+    u = ~u;
+    int32_t exponent = (u >> 4) & 0x07;
+    int32_t x = ((((int32_t)u & 0x0F) << 3) + 0x84) << exponent;
+    x -= 0x84;
+    return (u & 0x80) ? -x : x;
+}
+
+ML_Delay::ML_Delay(float sample_rate, int16_t *left, int16_t *right, uint32_t len)
+{
+    line_l = left;
+    line_r = right;
+    law_l = NULL;
+    law_r = NULL;
+    stereo = (right != NULL);
+    Init(sample_rate, (left != NULL) ? len : 0);
+}
+
+ML_Delay::ML_Delay(float sample_rate, uint8_t *left, uint8_t *right, uint32_t len)
+{
+    if (!muLawTableReady)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            muLawTable[i] = Delay_MuLawDecode(i);
+        }
+        muLawTableReady = true;
+    }
+
+    line_l = NULL;
+    line_r = NULL;
+    law_l = left;
+    law_r = right;
+    stereo = (right != NULL);
+    Init(sample_rate, (left != NULL) ? len : 0);
+}
+
+void ML_Delay::Init(float sample_rate, uint32_t len)
+{
+    this->sample_rate = sample_rate;
+    lineLen = (len > 4) ? (len - 1) : 0; /* last sample is the copy of the first one */
+    inPos = 0;
+    inLvl = 1.0f;
+    feedback = 0.0f;
+    outLvl = 1.0f;
+    bpm = 120.0f;
+    tapCount = 1;
+    minDelay = 1;
+
+    if (lineLen == 0)
+    {
+        Status_LogMessage("Not enough memory available for delay line!\n");
+        line_l = NULL;
+        line_r = NULL;
+        law_l = NULL;
+        law_r = NULL;
+        stereo = false;
+    }
+
+    for (uint32_t t = 0; t < ML_DELAY_TAP_MAX; t++)
+    {
+        taps[t].head.delay = 1;
+        taps[t].head.frac = 0.0f;
+        taps[t].headSet = false;
+        taps[t].fading = false;
+        taps[t].hasPending = false;
+        taps[t].fadeCnt = 0;
+        taps[t].beats = 0.0f;
+        taps[t].gain = 0.0f;
+        taps[t].pan = 0.5f;
+        TapGainUpdate(&taps[t]);
+    }
+
+    Reset();
+}
+
+void ML_Delay::Reset(void)
+{
+    if (line_l != NULL)
+    {
+        memset(line_l, 0, sizeof(int16_t) * (lineLen + 1));
+    }
+    if (line_r != NULL)
+    {
+        memset(line_r, 0, sizeof(int16_t) * (lineLen + 1));
+    }
+    if (law_l != NULL)
+    {
+        memset(law_l, Delay_MuLawEncode(0), lineLen + 1);
+    }
+    if (law_r != NULL)
+    {
+        memset(law_r, Delay_MuLawEncode(0), lineLen + 1);
+    }
+}
+
+/*
+ * linear interpolation between the sample at delay + 1 (weight frac) and delay
+ */
+void ML_Delay::ReadTap(const int16_t *line, const struct delay_head_s *head, float *buf, uint32_t len)
+{
+    const float wOld = head->frac * (1.0f / (float)0x4000);
+    const float wNew = (1.0f - head->frac) * (1.0f / (float)0x4000);
+
+    uint32_t pos = inPos + lineLen - head->delay - 1;
+    if (pos >= lineLen)
+    {
+        pos -= lineLen;
+    }
+
+    uint32_t n = 0;
+    while (n < len)
+    {
+        uint32_t span = lineLen - pos;
+        span = (span < len - n) ? span : (len - n);
+
+        const int16_t *src = &line[pos];
+        float *dst = &buf[n];
+        if (head->frac == 0.0f)
+        {
+            for (uint32_t i = 0; i < span; i++)
+            {
+                dst[i] = ((float)src[i + 1]) * wNew;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < span; i++)
+            {
+                dst[i] = ((float)src[i]) * wOld + ((float)src[i + 1]) * wNew;
+            }
+        }
+
+        n += span;
+        pos = 0;
+    }
+}
+
+void ML_Delay::ReadTap(const uint8_t *line, const struct delay_head_s *head, float *buf, uint32_t len)
+{
+    const float wOld = head->frac * (1.0f / (float)0x4000);
+    const float wNew = (1.0f - head->frac) * (1.0f / (float)0x4000);
+
+    uint32_t pos = inPos + lineLen - head->delay - 1;
+    if (pos >= lineLen)
+    {
+        pos -= lineLen;
+    }
+
+    uint32_t n = 0;
+    while (n < len)
+    {
+        uint32_t span = lineLen - pos;
+        span = (span < len - n) ? span : (len - n);
+
+        const uint8_t *src = &line[pos];
+        float *dst = &buf[n];
+        for (uint32_t i = 0; i < span; i++)
+        {
+            dst[i] = muLawTable[src[i]] * wOld + muLawTable[src[i + 1]] * wNew;
+        }
+
+        n += span;
+        pos = 0;
+    }
+}
+
+void ML_Delay::ReadTap(uint32_t ch, const struct delay_head_s *head, float *buf, uint32_t len)
+{
+    if (law_l != NULL)
+    {
+        ReadTap((ch == 0) ? law_l : law_r, head, buf, len);
+    }
+    else
+    {
+        ReadTap((ch == 0) ? line_l : line_r, head, buf, len);
+    }
+}
+
+void ML_Delay::WriteLine(int16_t *line, const float *in, const float *fb, uint32_t len)
+{
+    const float lvl = inLvl * (float)0x4000;
+    const float fbLvl = feedback * (float)0x4000;
+
+    uint32_t n = 0;
+    uint32_t pos = inPos;
+    while (n < len)
+    {
+        uint32_t span = lineLen - pos;
+        span = (span < len - n) ? span : (len - n);
+
+        int16_t *dst = &line[pos];
+        const float *src = &in[n];
+        const float *fbSrc = &fb[n];
+        for (uint32_t i = 0; i < span; i++)
+        {
+            float val = src[i] * lvl + fbSrc[i] * fbLvl;
+            val = (val < 32767.0f) ? val : 32767.0f;
+            val = (val > -32768.0f) ? val : -32768.0f;
+            dst[i] = (int16_t)val;
+        }
+
+        if (pos == 0)
+        {
+            line[lineLen] = line[0];
+        }
+
+        n += span;
+        pos = 0;
+    }
+}
+
+void ML_Delay::WriteLine(uint8_t *line, const float *in, const float *fb, uint32_t len)
+{
+    const float lvl = inLvl * (float)0x4000;
+    const float fbLvl = feedback * (float)0x4000;
+
+    uint32_t n = 0;
+    uint32_t pos = inPos;
+    while (n < len)
+    {
+        uint32_t span = lineLen - pos;
+        span = (span < len - n) ? span : (len - n);
+
+        uint8_t *dst = &line[pos];
+        const float *src = &in[n];
+        const float *fbSrc = &fb[n];
+        for (uint32_t i = 0; i < span; i++)
+        {
+            float val = src[i] * lvl + fbSrc[i] * fbLvl;
+            val = (val < 32767.0f) ? val : 32767.0f;
+            val = (val > -32768.0f) ? val : -32768.0f;
+            dst[i] = Delay_MuLawEncode((int32_t)val);
+        }
+
+        if (pos == 0)
+        {
+            line[lineLen] = line[0];
+        }
+
+        n += span;
+        pos = 0;
+    }
+}
+
+/*
+ * len must not exceed ML_DELAY_CHUNK and the shortest tap delay
+ * - the lines are written before the outputs are changed, in and out may be the same buffers
+ */
+void ML_Delay::ProcessChunk(const float *in_l, const float *in_r, float *out_l, float *out_r, uint32_t len)
+{
+    float tapBuf[ML_DELAY_CHUNK];
+    float fadeBuf[ML_DELAY_CHUNK];
+    float fbSum[ML_DELAY_CHUNK];
+    float wet_l[ML_DELAY_CHUNK];
+    float wet_r[ML_DELAY_CHUNK];
+    float monoIn[ML_DELAY_CHUNK];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        wet_l[n] = 0.0f;
+        wet_r[n] = 0.0f;
+    }
+
+    if (!stereo)
+    {
+        /* mono line, both inputs are fed into it */
+        for (uint32_t n = 0; n < len; n++)
+        {
+            monoIn[n] = 0.5f * (in_l[n] + in_r[n]);
+        }
+    }
+
+    for (uint32_t ch = 0; ch < (stereo ? 2 : 1); ch++)
+    {
+        for (uint32_t n = 0; n < len; n++)
+        {
+            fbSum[n] = 0.0f;
+        }
+
+        for (uint32_t t = 0; t < tapCount; t++)
+        {
+            const struct delay_tap_s *tap = &taps[t];
+
+            const float gain = tap->gain;
+            const float gainL = tap->gainL;
+            const float gainR = tap->gainR;
+
+            ReadTap(ch, &tap->head, tapBuf, len);
+
+            if (tap->fading)
+            {
+                const float step = 1.0f / (float)ML_DELAY_XFADE;
+                const float x0 = ((float)tap->fadeCnt) * step;
+
+                ReadTap(ch, &tap->next, fadeBuf, len);
+                for (uint32_t n = 0; n < len; n++)
+                {
+                    float x = x0 + step * (float)(n + 1);
+                    x = (x < 1.0f) ? x : 1.0f;
+                    tapBuf[n] += (fadeBuf[n] - tapBuf[n]) * x;
+                }
+            }
+
+            if (!stereo)
+            {
+                /* mono line, the pan is applied to the tap */
+                for (uint32_t n = 0; n < len; n++)
+                {
+                    wet_l[n] += tapBuf[n] * gainL;
+                    wet_r[n] += tapBuf[n] * gainR;
+                    fbSum[n] += tapBuf[n] * gain;
+                }
+            }
+            else
+            {
+                float *wet = (ch == 0) ? wet_l : wet_r;
+                const float gainOut = (ch == 0) ? gainL : gainR;
+                for (uint32_t n = 0; n < len; n++)
+                {
+                    wet[n] += tapBuf[n] * gainOut;
+                    fbSum[n] += tapBuf[n] * gain;
+                }
+            }
+        }
+
+        const float *in = (!stereo) ? monoIn : ((ch == 0) ? in_l : in_r);
+
+        if (law_l != NULL)
+        {
+            WriteLine((ch == 0) ? law_l : law_r, in, fbSum, len);
+        }
+        else
+        {
+            WriteLine((ch == 0) ? line_l : line_r, in, fbSum, len);
+        }
+    }
+
+    /* the inputs are not read anymore */
+    for (uint32_t n = 0; n < len; n++)
+    {
+        out_l[n] += wet_l[n];
+        out_r[n] += wet_r[n];
+    }
+
+    FadeUpdate(len);
+
+    inPos += len;
+    if (inPos >= lineLen)
+    {
+        inPos -= lineLen;
+    }
+}
+
+/*
+ * mono input, the output is added to out_l and out_r
+ */
+void ML_Delay::Process(const float *in, float *out_l, float *out_r, uint32_t len)
+{
+    Process(in, in, out_l, out_r, len);
+}
+
+/*
+ * stereo input, the output is added to out_l and out_r
+ */
+void ML_Delay::Process(const float *in_l, const float *in_r, float *out_l, float *out_r, uint32_t len)
+{
+    if (lineLen == 0)
+    {
+        return;
+    }
+
+    uint32_t n = 0;
+    while (n < len)
+    {
+        /* minDelay changes when a crossfade starts */
+        uint32_t cnt = (minDelay < ML_DELAY_CHUNK) ? minDelay : ML_DELAY_CHUNK;
+        cnt = (cnt < len - n) ? cnt : (len - n);
+        ProcessChunk(&in_l[n], &in_r[n], &out_l[n], &out_r[n], cnt);
+        n += cnt;
+    }
+}
+
+void ML_Delay::setInputLevel(float value)
+{
+    inLvl = value;
+}
+
+void ML_Delay::setFeedback(float value)
+{
+    feedback = value;
+}
+
+void ML_Delay::setOutputLevel(float value)
+{
+    outLvl = value;
+    for (uint32_t t = 0; t < ML_DELAY_TAP_MAX; t++)
+    {
+        TapGainUpdate(&taps[t]);
+    }
+}
+
+void ML_Delay::setTapCount(uint32_t count)
+{
+    tapCount = (count < ML_DELAY_TAP_MAX) ? count : ML_DELAY_TAP_MAX;
+    MinDelayUpdate();
+}
+
+void ML_Delay::MinDelayUpdate(void)
+{
+    minDelay = ML_DELAY_CHUNK;
+    for (uint32_t t = 0; t < tapCount; t++)
+    {
+        minDelay = (taps[t].head.delay < minDelay) ? taps[t].head.delay : minDelay;
+        if (taps[t].fading)
+        {
+            minDelay = (taps[t].next.delay < minDelay) ? taps[t].next.delay : minDelay;
+        }
+    }
+}
+
+/*
+ * called after each chunk, finishes crossfades and starts pending ones
+ */
+void ML_Delay::FadeUpdate(uint32_t len)
+{
+    bool changed = false;
+
+    for (uint32_t t = 0; t < ML_DELAY_TAP_MAX; t++)
+    {
+        struct delay_tap_s *tap = &taps[t];
+        if (!tap->fading)
+        {
+            continue;
+        }
+
+        tap->fadeCnt += len;
+        if (tap->fadeCnt >= ML_DELAY_XFADE)
+        {
+            tap->head = tap->next;
+            tap->fading = tap->hasPending;
+            tap->next = tap->pending;
+            tap->hasPending = false;
+            tap->fadeCnt = 0;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        MinDelayUpdate();
+    }
+}
+
+/*
+ * delay in samples, starts a crossfade to the new read position
+ */
+void ML_Delay::TapDelayUpdate(struct delay_tap_s *tap, float delay)
+{
+    float delayMax = (lineLen > 2) ? (float)(lineLen - 2) : 1.0f;
+    delay = (delay < 1.0f) ? 1.0f : delay;
+    delay = (delay > delayMax) ? delayMax : delay;
+
+    struct delay_head_s head;
+    head.delay = (uint32_t)delay;
+    head.frac = delay - (float)head.delay;
+
+    if (!tap->headSet)
+    {
+        tap->head = head;
+        tap->headSet = true;
+    }
+    else if (tap->fading)
+    {
+        tap->pending = head;
+        tap->hasPending = true;
+    }
+    else if ((head.delay != tap->head.delay) || (head.frac != tap->head.frac))
+    {
+        tap->next = head;
+        tap->fading = true;
+        tap->fadeCnt = 0;
+    }
+
+    MinDelayUpdate();
+}
+
+/*
+ * balance law, both sides get the full gain with pan = 0.5
+ */
+void ML_Delay::TapGainUpdate(struct delay_tap_s *tap)
+{
+    tap->gainL = tap->gain * outLvl * ((tap->pan > 0.5f) ? (2.0f - 2.0f * tap->pan) : 1.0f);
+    tap->gainR = tap->gain * outLvl * ((tap->pan < 0.5f) ? (2.0f * tap->pan) : 1.0f);
+}
+
+/*
+ * time in seconds (fractional samples are interpolated), pan from 0 (left) to 1 (right)
+ */
+void ML_Delay::setTap(uint32_t tap, float time, float gain, float pan)
+{
+    if (tap >= ML_DELAY_TAP_MAX)
+    {
+        return;
+    }
+
+    struct delay_tap_s *t = &taps[tap];
+    t->beats = 0.0f;
+    t->gain = gain;
+    t->pan = (pan < 0.0f) ? 0.0f : ((pan > 1.0f) ? 1.0f : pan);
+    TapGainUpdate(t);
+    TapDelayUpdate(t, time * sample_rate);
+}
+
+/*
+ * delay time in beats of the tempo, e.g. 0.75 for a dotted eighth
+ */
+void ML_Delay::setTapSync(uint32_t tap, float beats, float gain, float pan)
+{
+    if (tap >= ML_DELAY_TAP_MAX)
+    {
+        return;
+    }
+
+    setTap(tap, beats * 60.0f / bpm, gain, pan);
+    taps[tap].beats = beats;
+}
+
+/*
+ * changes only the delay time [s] of a tap
+ */
+void ML_Delay::setTapTime(uint32_t tap, float time)
+{
+    if (tap >= ML_DELAY_TAP_MAX)
+    {
+        return;
+    }
+
+    taps[tap].beats = 0.0f;
+    TapDelayUpdate(&taps[tap], time * sample_rate);
+}
+
+void ML_Delay::setTempo(float bpm)
+{
+    if (bpm <= 0.0f)
+    {
+        return;
+    }
+
+    this->bpm = bpm;
+    for (uint32_t t = 0; t < ML_DELAY_TAP_MAX; t++)
+    {
+        if (taps[t].beats > 0.0f)
+        {
+            TapDelayUpdate(&taps[t], taps[t].beats * 60.0f / bpm * sample_rate);
+        }
+    }
+}
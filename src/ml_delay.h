@@ -65,5 +65,101 @@ void Delay_SetLength(uint8_t unused __attribute__((unused)), uint8_t value);
 void Delay_SetShift(uint8_t unused __attribute__((unused)), float value);
 
 
+#ifndef ML_DELAY_TAP_MAX
+#define ML_DELAY_TAP_MAX    8
+#endif
+#define ML_DELAY_CHUNK      64 /* samples processed at once, limited by the shortest tap */
+#ifndef ML_DELAY_XFADE
+#define ML_DELAY_XFADE      1024 /* samples to crossfade between two read heads when the delay time changes */
+#endif
+
+/*
+ * instance based multi-tap delay
+ * - the lines are s16 (1.0 = 0x4000), right may be NULL for a mono line,
+ *   a mono line is fed with 0.5 * (in_l + in_r)
+ * - one sample of each line is used as a copy of the first one, this allows interpolation without wrap check
+ * - each block is read and written in at most two contiguous spans per tap
+ * - the taps are added to the output, the sum of all taps (with their gain) is fed back
+ * - the lines are written before the output is changed, in and out may be the same buffers
+ * - a change of the delay time crossfades from the old to the new read head,
+ *   a change during a running crossfade is started when it is finished
+ * - setTapSync derives the delay time from the tempo set with setTempo
+ * - with uint8_t lines the samples are stored 8 bit mu-law companded,
+ *   this doubles the delay time per byte of memory
+ */
+class ML_Delay
+{
+public:
+    ML_Delay(float sample_rate, int16_t *left, int16_t *right, uint32_t len);
+    ML_Delay(float sample_rate, uint8_t *left, uint8_t *right, uint32_t len);
+    ~ML_Delay() {};
+    void Reset(void);
+    void Process(const float *in, float *out_l, float *out_r, uint32_t len);
+    void Process(const float *in_l, const float *in_r, float *out_l, float *out_r, uint32_t len);
+    void setInputLevel(float value);
+    void setFeedback(float value);
+    void setOutputLevel(float value);
+    void setTapCount(uint32_t count);
+    void setTap(uint32_t tap, float time, float gain, float pan);
+    void setTapSync(uint32_t tap, float beats, float gain, float pan);
+    void setTapTime(uint32_t tap, float time);
+    void setTempo(float bpm);
+
+private:
+    struct delay_head_s
+    {
+        uint32_t delay; /* integer part of the delay in samples */
+        float frac;
+    };
+
+    struct delay_tap_s
+    {
+        struct delay_head_s head;
+        struct delay_head_s next; /* crossfade target */
+        struct delay_head_s pending; /* requested during a crossfade */
+        bool headSet; /* the first delay time is used without crossfade */
+        bool fading;
+        bool hasPending;
+        uint32_t fadeCnt;
+        float beats; /* > 0 when synced to the tempo */
+        float gain;
+        float pan;
+        float gainL;
+        float gainR;
+    };
+
+    void Init(float sample_rate, uint32_t len);
+    void ProcessChunk(const float *in_l, const float *in_r, float *out_l, float *out_r, uint32_t len);
+    void ReadTap(const int16_t *line, const struct delay_head_s *head, float *buf, uint32_t len);
+    void ReadTap(const uint8_t *line, const struct delay_head_s *head, float *buf, uint32_t len);
+    void ReadTap(uint32_t ch, const struct delay_head_s *head, float *buf, uint32_t len);
+    void WriteLine(int16_t *line, const float *in, const float *fb, uint32_t len);
+    void WriteLine(uint8_t *line, const float *in, const float *fb, uint32_t len);
+    void TapGainUpdate(struct delay_tap_s *tap);
+    void TapDelayUpdate(struct delay_tap_s *tap, float delay);
+    void FadeUpdate(uint32_t len);
+    void MinDelayUpdate(void);
+
+    float sample_rate;
+    int16_t *line_l;
+    int16_t *line_r;
+    uint8_t *law_l;
+    uint8_t *law_r;
+    bool stereo;
+    uint32_t lineLen;
+    uint32_t inPos;
+    float inLvl;
+    float feedback;
+    float outLvl;
+    float bpm;
+    uint32_t tapCount;
+    uint32_t minDelay;
+    struct delay_tap_s taps[ML_DELAY_TAP_MAX];
+
+    static float muLawTable[256];
+    static bool muLawTableReady;
+};
+
+
 #endif /* SRC_ML_DELAY_H_ */
 
@@ -47,6 +47,7 @@
 
 #include "ml_env.h"
 #include <stdint.h>
+#include <math.h>
 
 struct
 {
@@ -158,3 +159,234 @@ void ASDR_Init(struct adsrT *ctrl, float a, float d, float s, float r)
     ctrl->r = r;
 }
 
+/*
+ * advances one envelope by a whole block
+ * - the stage is only checked when a boundary is crossed
+ * - linear segments give the same values as ADSR_Process
+ * - exponential decay / release: ctrl = s + (ctrl - s) * k
+ */
+static inline bool ADSR_Block(float a, float d, float s, float r, bool exponential, float *ctrlP, adsr_phaseT *phaseP, float *gain, uint32_t len)
+{
+    float c = *ctrlP;
+    adsr_phaseT phase = *phaseP;
+    uint32_t n = 0;
+
+    while (n < len)
+    {
+        switch (phase)
+        {
+        case attack:
+            for (; n < len; n++)
+            {
+                c += a;
+                if (c > 1.0f)
+                {
+                    break;
+                }
+                gain[n] = c;
+            }
+            if (n < len)
+            {
+                c = 1.0f;
+                phase = decay;
+                gain[n++] = c;
+            }
+            break;
+
+        case decay:
+            if (exponential)
+            {
+                for (; n < len; n++)
+                {
+                    c = s + (c - s) * d;
+                    if (c - s < ADSR_EXP_FLOOR)
+                    {
+                        break;
+                    }
+                    gain[n] = c;
+                }
+            }
+            else
+            {
+                for (; n < len; n++)
+                {
+                    c -= d;
+                    if (c < s)
+                    {
+                        break;
+                    }
+                    gain[n] = c;
+                }
+            }
+            if (n < len)
+            {
+                c = s;
+                phase = sustain;
+                gain[n++] = c;
+            }
+            break;
+
+        case sustain:
+            for (; n < len; n++)
+            {
+                gain[n] = c;
+            }
+            break;
+
+        case release:
+            if (exponential)
+            {
+                for (; n < len; n++)
+                {
+                    c *= r;
+                    if (c < ADSR_EXP_FLOOR)
+                    {
+                        break;
+                    }
+                    gain[n] = c;
+                }
+            }
+            else
+            {
+                for (; n < len; n++)
+                {
+                    c -= r;
+                    if (c < 0.0f)
+                    {
+                        break;
+                    }
+                    gain[n] = c;
+                }
+            }
+            if (n < len)
+            {
+                phase = idle;
+            }
+            break;
+
+        case idle:
+            c = 0.0f;
+            for (; n < len; n++)
+            {
+                gain[n] = 0.0f;
+            }
+            break;
+        }
+    }
+
+    *ctrlP = c;
+    *phaseP = phase;
+
+    return phase != idle;
+}
+
+/*
+ * fills gain with len values of the envelope
+ * returns false when the envelope is idle at the end of the block
+ */
+bool ADSR_ProcessBlock(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr, float *gain, uint32_t len)
+{
+    return ADSR_Block(ctrl->a, ctrl->d, ctrl->s, ctrl->r, false, &adsr->ctrl, &adsr->phase, gain, len);
+}
+
+/*
+ * multiplier for an exponential segment falling to ADSR_EXP_FLOOR within time [s]
+ * - only required when the parameter changes
+ */
+float ADSR_ExpCoeff(float time)
+{
+    float samples = time * envCfg.sample_rate;
+    if (samples < 1.0f)
+    {
+        return 0.0f;
+    }
+    return expf(logf(ADSR_EXP_FLOOR) / samples);
+}
+
+void ADSR_Bank_Init(struct adsr_bank_s *bank, uint32_t count)
+{
+    bank->count = (count > ADSR_BANK_MAX) ? ADSR_BANK_MAX : count;
+    bank->activeMask = 0;
+    bank->expMask = 0;
+    for (uint32_t i = 0; i < ADSR_BANK_MAX; i++)
+    {
+        bank->a[i] = 0.0f;
+        bank->d[i] = 0.0f;
+        bank->s[i] = 0.0f;
+        bank->r[i] = 0.0f;
+        bank->ctrl[i] = 0.0f;
+        bank->phase[i] = idle;
+    }
+}
+
+/*
+ * idx must be below the count passed to ADSR_Bank_Init, other values are ignored
+ */
+void ADSR_Bank_Set(struct adsr_bank_s *bank, uint32_t idx, const struct adsrT *ctrl, bool exponential)
+{
+    if (idx >= bank->count)
+    {
+        return;
+    }
+
+    bank->a[idx] = ctrl->a;
+    bank->d[idx] = ctrl->d;
+    bank->s[idx] = ctrl->s;
+    bank->r[idx] = ctrl->r;
+    if (exponential)
+    {
+        bank->expMask |= 1UL << idx;
+    }
+    else
+    {
+        bank->expMask &= ~(1UL << idx);
+    }
+}
+
+void ADSR_Bank_Start(struct adsr_bank_s *bank, uint32_t idx)
+{
+    if (idx >= bank->count)
+    {
+        return;
+    }
+
+    bank->ctrl[idx] = bank->a[idx];
+    bank->phase[idx] = (bank->a[idx] == 1.0f) ? decay : attack;
+    bank->activeMask |= 1UL << idx;
+}
+
+void ADSR_Bank_Release(struct adsr_bank_s *bank, uint32_t idx)
+{
+    if ((idx < bank->count) && (bank->phase[idx] != idle))
+    {
+        bank->phase[idx] = release;
+    }
+}
+
+/*
+ * advances all active envelopes of the bank by len samples
+ * - gain[idx] receives the values of envelope idx, idle envelopes are skipped
+ * - returns the mask of envelopes which went idle within this block
+ */
+uint32_t ADSR_Bank_Process(struct adsr_bank_s *bank, float *const *gain, uint32_t len)
+{
+    uint32_t active = bank->activeMask;
+    uint32_t finished = 0;
+
+    while (active != 0)
+    {
+        uint32_t idx = __builtin_ctz(active);
+        uint32_t bit = 1UL << idx;
+        active &= ~bit;
+
+        if (!ADSR_Block(bank->a[idx], bank->d[idx], bank->s[idx], bank->r[idx], (bank->expMask & bit) != 0,
+                        &bank->ctrl[idx], &bank->phase[idx], gain[idx], len))
+        {
+            finished |= bit;
+        }
+    }
+
+    bank->activeMask &= ~finished;
+
+    return finished;
+}
@@ -48,6 +48,9 @@
 #define ML_ENV_H_
 
 
+#include <stdint.h>
+
+
 struct adsrT
 {
     float a;
@@ -77,6 +80,31 @@ struct asmT
     float r;
 };
 
+#ifndef ADSR_BANK_MAX
+#define ADSR_BANK_MAX   32 /* limited by the 32 bit voice masks */
+#endif
+
+/* exponential segments end below this level */
+#define ADSR_EXP_FLOOR  0.0001f
+
+/*
+ * envelopes stored as arrays (structure of arrays)
+ * - a, s are used like in adsrT
+ * - d, r are linear steps or multipliers from ADSR_ExpCoeff when the bit in expMask is set
+ */
+struct adsr_bank_s
+{
+    uint32_t count;
+    uint32_t activeMask;
+    uint32_t expMask;
+    float a[ADSR_BANK_MAX];
+    float d[ADSR_BANK_MAX];
+    float s[ADSR_BANK_MAX];
+    float r[ADSR_BANK_MAX];
+    float ctrl[ADSR_BANK_MAX];
+    adsr_phaseT phase[ADSR_BANK_MAX];
+};
+
 
 void ADSR_SetSamplerate(float sample_rate);
 void ASDR_Init(struct adsrT *ctrl, float a, float d, float s, float r);
@@ -84,6 +112,14 @@ bool ADSR_Process(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr);
 void ADSR_Start(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr);
 bool ASRM_Process(const struct adsrT *ctrl, struct adsr_ctrl_t *asr);
 void ASRM_Start(const struct adsrT *ctrl, struct adsr_ctrl_t *asr);
+bool ADSR_ProcessBlock(const struct adsrT *ctrl, struct adsr_ctrl_t *adsr, float *gain, uint32_t len);
+
+float ADSR_ExpCoeff(float time);
+void ADSR_Bank_Init(struct adsr_bank_s *bank, uint32_t count);
+void ADSR_Bank_Set(struct adsr_bank_s *bank, uint32_t idx, const struct adsrT *ctrl, bool exponential);
+void ADSR_Bank_Start(struct adsr_bank_s *bank, uint32_t idx);
+void ADSR_Bank_Release(struct adsr_bank_s *bank, uint32_t idx);
+uint32_t ADSR_Bank_Process(struct adsr_bank_s *bank, float *const *gain, uint32_t len);
 
 
 
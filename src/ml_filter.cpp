@@ -47,10 +47,26 @@
 
 #include "ml_filter.h"
 #include "ml_waveform.h"
+#include "ml_status.h"
 
 
 #include <math.h>
+#include <stdlib.h>
 
+#if defined(__ARM_FEATURE_DSP) && !defined(FILTER_Q16_REFERENCE)
+#include <arm_acle.h>
+#define FILTER_Q16_DSP
+#endif
+
+#if (FILTER_BANK_LANES % 4) == 0
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define FILTER_BANK_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FILTER_BANK_NEON
+#endif
+#endif
 
 /* will be removed in future */
 extern float *sine;
@@ -100,15 +116,314 @@ void Filter_Process(float *const signal, struct filterProcT *const filterP)
     *signal = out;
 }
 
+/*
+ * coefficients and state are kept in local variables,
+ * otherwise they would be reloaded after every write to signal
+ */
 void Filter_Process_Buffer(float *const signal, struct filterProcT *const filterP, uint32_t len)
 {
+    const float b0 = filterP->filterCoeff->bNorm[0];
+    const float b1 = filterP->filterCoeff->bNorm[1];
+    const float b2 = filterP->filterCoeff->bNorm[2];
+    const float a0 = filterP->filterCoeff->aNorm[0];
+    const float a1 = filterP->filterCoeff->aNorm[1];
+    float w0 = filterP->w[0];
+    float w1 = filterP->w[1];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        const float out = b0 * signal[n] + w0;
+        w0 = b1 * signal[n] - a0 * out + w1;
+        w1 = b2 * signal[n] - a1 * out;
+        signal[n] = out;
+    }
+
+    filterP->w[0] = w0;
+    filterP->w[1] = w1;
+}
+
+/*
+ * ramps the coefficients from filterCur to filterP->filterCoeff over the buffer
+ * filterCur is updated and must be kept for the next call (init it with the first coefficients)
+ * linear interpolated coefficients are stable when start and end are stable
+ */
+void Filter_Process_Buffer(float *const signal, struct filterProcT *const filterP, struct filterCoeffT *const filterCur, uint32_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    const float step = 1.0f / (float)len;
+    float c[5], d[5];
+
+    for (int i = 0; i < 5; i++)
+    {
+        c[i] = filterCur->coef[i];
+        d[i] = (filterP->filterCoeff->coef[i] - c[i]) * step;
+    }
+
+    float w0 = filterP->w[0];
+    float w1 = filterP->w[1];
+
     for (uint32_t n = 0; n < len; n++)
     {
-        const float out = filterP->filterCoeff->bNorm[0] * signal[n] + filterP->w[0];
-        filterP->w[0] = filterP->filterCoeff->bNorm[1] * signal[n] - filterP->filterCoeff->aNorm[0] * out + filterP->w[1];
-        filterP->w[1] = filterP->filterCoeff->bNorm[2] * signal[n] - filterP->filterCoeff->aNorm[1] * out;
+        for (int i = 0; i < 5; i++)
+        {
+            c[i] += d[i];
+        }
+
+        /* c[0..2]: bNorm, c[3..4]: aNorm */
+        const float out = c[0] * signal[n] + w0;
+        w0 = c[1] * signal[n] - c[3] * out + w1;
+        w1 = c[2] * signal[n] - c[4] * out;
         signal[n] = out;
     }
+
+    filterP->w[0] = w0;
+    filterP->w[1] = w1;
+
+    /* the target is taken as it is to avoid accumulated rounding errors */
+    *filterCur = *filterP->filterCoeff;
+}
+
+/*
+ * calc is called for every table entry (e.g. Filter_CalculateLowPass)
+ * the cutoff axis covers 0..1, the resonance axis goes from 1 / resoMin to 1 / resoMax
+ */
+bool Filter_CoeffTable_Init(struct filterCoeffTableT *const table, filterCalcFn calc, float resoMin, float resoMax)
+{
+    table->pole = (struct filterPoleT *)malloc(sizeof(struct filterPoleT) * FILTER_TABLE_CUTOFF_CNT * FILTER_TABLE_RESO_CNT);
+    if (table->pole == NULL)
+    {
+        Status_LogMessage("not enough heap memory for filter table!\n");
+        return false;
+    }
+
+    const float invMin = 1.0f / resoMin;
+    const float invMax = 1.0f / resoMax;
+
+    table->invResoMin = invMin;
+    table->resoScale = (invMin > invMax) ? ((float)(FILTER_TABLE_RESO_CNT - 1) / (invMin - invMax)) : 0.0f;
+
+    for (uint32_t r = 0; r < FILTER_TABLE_RESO_CNT; r++)
+    {
+        const float inv = invMin - ((FILTER_TABLE_RESO_CNT > 1) ? ((invMin - invMax) * (float)r / (float)(FILTER_TABLE_RESO_CNT - 1)) : 0.0f);
+        for (uint32_t i = 0; i < FILTER_TABLE_CUTOFF_CNT; i++)
+        {
+            struct filterCoeffT coeff;
+            struct filterPoleT *pole = &table->pole[r * FILTER_TABLE_CUTOFF_CNT + i];
+
+            calc((float)i / (float)(FILTER_TABLE_CUTOFF_CNT - 1), 1.0f / inv, &coeff);
+
+            /* 1 + a0 z^-1 + a1 z^-2 with the poles radius * e^(+-j angle * 2) */
+            const float radius = sqrtf((coeff.aNorm[1] > 0.0f) ? coeff.aNorm[1] : 0.0f);
+            float cosAngle = (radius > 0.0f) ? (-coeff.aNorm[0] / (2.0f * radius)) : 1.0f;
+            cosAngle = (cosAngle > 1.0f) ? 1.0f : ((cosAngle < -1.0f) ? -1.0f : cosAngle);
+
+            pole->bNorm[0] = coeff.bNorm[0];
+            pole->bNorm[1] = coeff.bNorm[1];
+            pole->bNorm[2] = coeff.bNorm[2];
+            pole->radius = radius;
+            pole->angle = 0.5f * acosf(cosAngle);
+        }
+    }
+
+    return true;
+}
+
+/*
+ * replaces the call of the Filter_Calculate function used to fill the table
+ * values outside of the table are clamped
+ */
+void Filter_CoeffTable_Lookup(const struct filterCoeffTableT *const table, float c, float reso, struct filterCoeffT *const filterC)
+{
+    float fc = c * (float)(FILTER_TABLE_CUTOFF_CNT - 1);
+    float fr = (reso > 0.0f) ? ((table->invResoMin - 1.0f / reso) * table->resoScale) : 0.0f;
+
+    fc = (fc < 0.0f) ? 0.0f : ((fc > (float)(FILTER_TABLE_CUTOFF_CNT - 1)) ? (float)(FILTER_TABLE_CUTOFF_CNT - 1) : fc);
+    fr = (fr < 0.0f) ? 0.0f : ((fr > (float)(FILTER_TABLE_RESO_CNT - 1)) ? (float)(FILTER_TABLE_RESO_CNT - 1) : fr);
+
+    uint32_t ic = (uint32_t)fc;
+    uint32_t ir = (uint32_t)fr;
+    ic = (ic < FILTER_TABLE_CUTOFF_CNT - 1) ? ic : (FILTER_TABLE_CUTOFF_CNT - 2);
+    ir = (ir < FILTER_TABLE_RESO_CNT - 1) ? ir : ((FILTER_TABLE_RESO_CNT > 1) ? (FILTER_TABLE_RESO_CNT - 2) : 0);
+
+    const float xc = fc - (float)ic;
+    const float xr = fr - (float)ir;
+
+    const float *p00 = &table->pole[ir * FILTER_TABLE_CUTOFF_CNT + ic].bNorm[0];
+    const float *p01 = &table->pole[ir * FILTER_TABLE_CUTOFF_CNT + ic + 1].bNorm[0];
+    const float *p10 = (FILTER_TABLE_RESO_CNT > 1) ? (p00 + 5 * FILTER_TABLE_CUTOFF_CNT) : p00;
+    const float *p11 = (FILTER_TABLE_RESO_CNT > 1) ? (p01 + 5 * FILTER_TABLE_CUTOFF_CNT) : p01;
+    float v[5];
+
+    for (int i = 0; i < 5; i++)
+    {
+        const float lo = p00[i] + (p01[i] - p00[i]) * xc;
+        const float hi = p10[i] + (p11[i] - p10[i]) * xc;
+        v[i] = lo + (hi - lo) * xr;
+    }
+
+    /*
+     * cos(2 x) = 1 - 2 sin(x)^2 keeps the precision for small angles,
+     * sin(x) for x in 0..pi/2 by its taylor series (error < 4e-6)
+     */
+    const float x = v[4];
+    const float x2 = x * x;
+    const float sinX = x * (1.0f - x2 * (1.0f / 6.0f) * (1.0f - x2 * (1.0f / 20.0f) * (1.0f - x2 * (1.0f / 42.0f) * (1.0f - x2 * (1.0f / 72.0f)))));
+    const float cosAngle = 1.0f - 2.0f * sinX * sinX;
+
+    filterC->bNorm[0] = v[0];
+    filterC->bNorm[1] = v[1];
+    filterC->bNorm[2] = v[2];
+    filterC->aNorm[0] = -2.0f * v[3] * cosAngle;
+    filterC->aNorm[1] = v[3] * v[3];
+}
+
+/*
+ * all lanes are using filterC until Filter_Bank_SetCoeff is called
+ */
+void Filter_Bank_Init(struct filterBankT *const bank, struct filterCoeffT *const filterC)
+{
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        bank->filterCoeff[l] = filterC;
+    }
+    Filter_Bank_Reset(bank);
+}
+
+void Filter_Bank_SetCoeff(struct filterBankT *const bank, uint32_t lane, struct filterCoeffT *const filterC)
+{
+    if (lane < FILTER_BANK_LANES)
+    {
+        bank->filterCoeff[lane] = filterC;
+    }
+}
+
+void Filter_Bank_Reset(struct filterBankT *const bank)
+{
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        bank->w[0][l] = 0.0f;
+        bank->w[1][l] = 0.0f;
+    }
+}
+
+/*
+ * signal points to one buffer per lane, each one is filtered in place
+ * the operations are done in the same order as in Filter_Process_Buffer
+ */
+void Filter_Bank_Process_Buffer(float *const *signal, struct filterBankT *const bank, uint32_t len)
+{
+    float b0[FILTER_BANK_LANES], b1[FILTER_BANK_LANES], b2[FILTER_BANK_LANES];
+    float a0[FILTER_BANK_LANES], a1[FILTER_BANK_LANES];
+
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        b0[l] = bank->filterCoeff[l]->bNorm[0];
+        b1[l] = bank->filterCoeff[l]->bNorm[1];
+        b2[l] = bank->filterCoeff[l]->bNorm[2];
+        a0[l] = bank->filterCoeff[l]->aNorm[0];
+        a1[l] = bank->filterCoeff[l]->aNorm[1];
+    }
+
+#if defined(FILTER_BANK_SSE)
+    for (uint32_t g = 0; g < FILTER_BANK_LANES; g += 4)
+    {
+        float *const s0 = signal[g + 0];
+        float *const s1 = signal[g + 1];
+        float *const s2 = signal[g + 2];
+        float *const s3 = signal[g + 3];
+
+        const __m128 vb0 = _mm_loadu_ps(&b0[g]);
+        const __m128 vb1 = _mm_loadu_ps(&b1[g]);
+        const __m128 vb2 = _mm_loadu_ps(&b2[g]);
+        const __m128 va0 = _mm_loadu_ps(&a0[g]);
+        const __m128 va1 = _mm_loadu_ps(&a1[g]);
+        __m128 w0 = _mm_loadu_ps(&bank->w[0][g]);
+        __m128 w1 = _mm_loadu_ps(&bank->w[1][g]);
+
+        for (uint32_t n = 0; n < len; n++)
+        {
+            const __m128 x = _mm_setr_ps(s0[n], s1[n], s2[n], s3[n]);
+            const __m128 out = _mm_add_ps(_mm_mul_ps(vb0, x), w0);
+            w0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vb1, x), _mm_mul_ps(va0, out)), w1);
+            w1 = _mm_sub_ps(_mm_mul_ps(vb2, x), _mm_mul_ps(va1, out));
+
+            float o[4];
+            _mm_storeu_ps(o, out);
+            s0[n] = o[0];
+            s1[n] = o[1];
+            s2[n] = o[2];
+            s3[n] = o[3];
+        }
+
+        _mm_storeu_ps(&bank->w[0][g], w0);
+        _mm_storeu_ps(&bank->w[1][g], w1);
+    }
+#elif defined(FILTER_BANK_NEON)
+    for (uint32_t g = 0; g < FILTER_BANK_LANES; g += 4)
+    {
+        float *const s0 = signal[g + 0];
+        float *const s1 = signal[g + 1];
+        float *const s2 = signal[g + 2];
+        float *const s3 = signal[g + 3];
+
+        const float32x4_t vb0 = vld1q_f32(&b0[g]);
+        const float32x4_t vb1 = vld1q_f32(&b1[g]);
+        const float32x4_t vb2 = vld1q_f32(&b2[g]);
+        const float32x4_t va0 = vld1q_f32(&a0[g]);
+        const float32x4_t va1 = vld1q_f32(&a1[g]);
+        float32x4_t w0 = vld1q_f32(&bank->w[0][g]);
+        float32x4_t w1 = vld1q_f32(&bank->w[1][g]);
+
+        for (uint32_t n = 0; n < len; n++)
+        {
+            const float in[4] = {s0[n], s1[n], s2[n], s3[n]};
+            const float32x4_t x = vld1q_f32(in);
+            /* no vmla/vfma, the rounding has to be the same as in the scalar version */
+            const float32x4_t out = vaddq_f32(vmulq_f32(vb0, x), w0);
+            w0 = vaddq_f32(vsubq_f32(vmulq_f32(vb1, x), vmulq_f32(va0, out)), w1);
+            w1 = vsubq_f32(vmulq_f32(vb2, x), vmulq_f32(va1, out));
+
+            s0[n] = vgetq_lane_f32(out, 0);
+            s1[n] = vgetq_lane_f32(out, 1);
+            s2[n] = vgetq_lane_f32(out, 2);
+            s3[n] = vgetq_lane_f32(out, 3);
+        }
+
+        vst1q_f32(&bank->w[0][g], w0);
+        vst1q_f32(&bank->w[1][g], w1);
+    }
+#else
+    /* scalar fallback, the lanes are kept in the inner loop to allow auto vectorization */
+    float w0[FILTER_BANK_LANES], w1[FILTER_BANK_LANES];
+
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        w0[l] = bank->w[0][l];
+        w1[l] = bank->w[1][l];
+    }
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+        {
+            const float x = signal[l][n];
+            const float out = b0[l] * x + w0[l];
+            w0[l] = b1[l] * x - a0[l] * out + w1[l];
+            w1[l] = b2[l] * x - a1[l] * out;
+            signal[l][n] = out;
+        }
+    }
+
+    for (uint32_t l = 0; l < FILTER_BANK_LANES; l++)
+    {
+        bank->w[0][l] = w0[l];
+        bank->w[1][l] = w1[l];
+    }
+#endif
 }
 
 /*
@@ -231,3 +546,546 @@ float Filter_AmplitudeFilterResponse(float c, struct filterCoeffT *const filterC
                );
 }
 
+
+/*
+ * zero delay feedback filters
+ * @see Vadim Zavalishin, The Art of VA Filter Design
+ */
+#define ZDF_CNT         (1 << FILTER_ZDF_TABLE_BIT)
+#define ZDF_Q16_CNT     (1 << FILTER_ZDF_Q16_TABLE_BIT)
+#define ZDF_Q16_FRAC    28 /* fractional bits of the Q1_14 coefficients */
+#define ZDF_Q16_ONE     (1L << ZDF_Q16_FRAC)
+#define ZDF_Q16_STATE   8 /* additional fractional bits of the Q1_14 state */
+#define ZDF_Q16_LIMIT   (32L << (14 + ZDF_Q16_STATE)) /* states are saturated to +-32.0, keeps all sums within int32 */
+#define ZDF_RECIP_BIT   7 /* mantissa bits used as reciprocal table index */
+#define ZDF_RECIP_CNT   (1 << ZDF_RECIP_BIT)
+
+/* prewarped integrator gain g and one-pole gain g / (1 + g), one entry more for the interpolation */
+static float zdfG[ZDF_CNT + 1];
+static float zdfOnePole[ZDF_CNT + 1];
+/* 1 / m for the mantissa m = 1..2, taken at the center of each step */
+static float zdfRecip[ZDF_RECIP_CNT];
+
+struct zdfSvfCoeffQ16
+{
+    int32_t a1;
+    int32_t a2;
+    int32_t a3;
+};
+
+struct zdfLadderCoeffQ16
+{
+    int32_t G;
+    int32_t norm; /* 1 / (1 + k * G^4) */
+};
+
+static struct zdfSvfCoeffQ16 *zdfSvfQ16 = NULL; /* [reso][cutoff] */
+static struct zdfLadderCoeffQ16 *zdfLadderQ16 = NULL;
+
+/*
+ * same cutoff curve as Filter_CalculateLowPass, the upper limit keeps g finite
+ */
+static double Filter_ZdfG(float c)
+{
+    double omega = (double)c * c * c;
+    omega = (omega < 0.0025) ? 0.0025 : ((omega > 0.98) ? 0.98 : omega);
+    return tan(M_PI * 0.5 * omega);
+}
+
+static float Filter_SvfK(float reso)
+{
+    reso = (reso < 0.0f) ? 0.0f : ((reso > 1.0f) ? 1.0f : reso);
+    return 2.0f - 1.99f * reso;
+}
+
+static float Filter_LadderK(float reso)
+{
+    reso = (reso < 0.0f) ? 0.0f : ((reso > 1.0f) ? 1.0f : reso);
+    return 4.0f * reso;
+}
+
+void Filter_Zdf_Init(void)
+{
+    for (uint32_t i = 0; i <= ZDF_CNT; i++)
+    {
+        const double g = Filter_ZdfG((float)i / (float)ZDF_CNT);
+        zdfG[i] = (float)g;
+        zdfOnePole[i] = (float)(g / (1.0 + g));
+    }
+    for (uint32_t i = 0; i < ZDF_RECIP_CNT; i++)
+    {
+        zdfRecip[i] = (float)(1.0 / (1.0 + ((double)i + 0.5) / (double)ZDF_RECIP_CNT));
+    }
+}
+
+/*
+ * the tables are shared by all Q1_14 svf and ladder filters
+ */
+bool Filter_Zdf_InitQ16(void)
+{
+    if (zdfSvfQ16 == NULL)
+    {
+        zdfSvfQ16 = (struct zdfSvfCoeffQ16 *)malloc(sizeof(struct zdfSvfCoeffQ16) * ZDF_Q16_CNT * FILTER_ZDF_Q16_RESO_CNT);
+    }
+    if (zdfLadderQ16 == NULL)
+    {
+        zdfLadderQ16 = (struct zdfLadderCoeffQ16 *)malloc(sizeof(struct zdfLadderCoeffQ16) * ZDF_Q16_CNT * FILTER_ZDF_Q16_RESO_CNT);
+    }
+    if ((zdfSvfQ16 == NULL) || (zdfLadderQ16 == NULL))
+    {
+        Status_LogMessage("not enough heap memory for zdf filter table!\n");
+        return false;
+    }
+
+    for (uint32_t r = 0; r < FILTER_ZDF_Q16_RESO_CNT; r++)
+    {
+        const float reso = (float)r / (float)(FILTER_ZDF_Q16_RESO_CNT - 1);
+        const double k = Filter_SvfK(reso);
+        const double kLadder = Filter_LadderK(reso);
+
+        for (uint32_t i = 0; i < ZDF_Q16_CNT; i++)
+        {
+            const double g = Filter_ZdfG((float)i / (float)ZDF_Q16_CNT);
+            const double a1 = 1.0 / (1.0 + g * (g + k));
+            const double G = g / (1.0 + g);
+
+            struct zdfSvfCoeffQ16 *svf = &zdfSvfQ16[r * ZDF_Q16_CNT + i];
+            svf->a1 = (int32_t)(a1 * ZDF_Q16_ONE);
+            svf->a2 = (int32_t)(g * a1 * ZDF_Q16_ONE);
+            svf->a3 = (int32_t)(g * g * a1 * ZDF_Q16_ONE);
+
+            struct zdfLadderCoeffQ16 *ladder = &zdfLadderQ16[r * ZDF_Q16_CNT + i];
+            ladder->G = (int32_t)(G * ZDF_Q16_ONE);
+            ladder->norm = (int32_t)(ZDF_Q16_ONE / (1.0 + kLadder * G * G * G * G));
+        }
+    }
+
+    return true;
+}
+
+static inline float Filter_ZdfLookup(const float *table, float c)
+{
+    float f = c * (float)ZDF_CNT;
+    f = (f < 0.0f) ? 0.0f : ((f > (float)ZDF_CNT) ? (float)ZDF_CNT : f);
+    uint32_t i = (uint32_t)f;
+    i = (i < ZDF_CNT) ? i : (ZDF_CNT - 1);
+    const float x = f - (float)i;
+    return table[i] + (table[i + 1] - table[i]) * x;
+}
+
+/*
+ * 1 / d for d >= 1 without a division: the table gives about 8 bits,
+ * each newton step r * (2 - d * r) doubles them and stays below 1 / d,
+ * that keeps the filters on the damped side
+ */
+static inline float Filter_ZdfRecip(float d)
+{
+    union
+    {
+        float f;
+        uint32_t u;
+    } v;
+    v.f = d;
+    const float m = zdfRecip[(v.u >> (23 - ZDF_RECIP_BIT)) & (ZDF_RECIP_CNT - 1)];
+    v.u = (254UL << 23) - (v.u & 0x7F800000UL); /* 2^-exponent */
+    float r = m * v.f;
+    r = r * (2.0f - d * r);
+    r = r * (2.0f - d * r);
+    return r;
+}
+
+static inline uint32_t Filter_ZdfIndexQ16(Q1_14 c)
+{
+    int32_t i = c.s16 >> (14 - FILTER_ZDF_Q16_TABLE_BIT);
+    return (i < 0) ? 0 : ((i >= ZDF_Q16_CNT) ? (ZDF_Q16_CNT - 1) : i);
+}
+
+static inline int32_t Filter_MulQ16(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> ZDF_Q16_FRAC);
+}
+
+static inline int32_t Filter_LimitQ16(int32_t v)
+{
+    return (v > ZDF_Q16_LIMIT) ? ZDF_Q16_LIMIT : ((v < -ZDF_Q16_LIMIT) ? -ZDF_Q16_LIMIT : v);
+}
+
+static inline int16_t Filter_SatQ16(int32_t v)
+{
+    v >>= ZDF_Q16_STATE;
+    return (v > INT16_MAX) ? INT16_MAX : ((v < INT16_MIN) ? INT16_MIN : v);
+}
+
+void Filter_Svf_Init(struct filterSvfT *const svf)
+{
+    svf->ic1eq = 0.0f;
+    svf->ic2eq = 0.0f;
+    svf->k = Filter_SvfK(0.0f);
+    svf->cutoff = 1.0f;
+}
+
+void Filter_Svf_SetReso(struct filterSvfT *const svf, float reso)
+{
+    svf->k = Filter_SvfK(reso);
+}
+
+/*
+ * mode: filter_svf_mode_e
+ */
+void Filter_Svf_Process_Buffer(float *const signal, struct filterSvfT *const svf, const float *cutoff, uint32_t len, uint8_t mode)
+{
+    const float k = svf->k;
+    float ic1eq = svf->ic1eq;
+    float ic2eq = svf->ic2eq;
+    float g = Filter_ZdfLookup(zdfG, svf->cutoff);
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        if (cutoff != NULL)
+        {
+            g = Filter_ZdfLookup(zdfG, cutoff[n]);
+        }
+
+        const float a1 = Filter_ZdfRecip(1.0f + g * (g + k));
+        const float a2 = g * a1;
+        const float a3 = g * a2;
+
+        const float x = signal[n];
+        const float v3 = x - ic2eq;
+        const float v1 = a1 * ic1eq + a2 * v3;
+        const float v2 = ic2eq + a2 * ic1eq + a3 * v3;
+        ic1eq = 2.0f * v1 - ic1eq;
+        ic2eq = 2.0f * v2 - ic2eq;
+
+        switch (mode)
+        {
+        case filter_svf_bp:
+            signal[n] = v1;
+            break;
+        case filter_svf_hp:
+            signal[n] = x - k * v1 - v2;
+            break;
+        case filter_svf_notch:
+            signal[n] = x - k * v1;
+            break;
+        default:
+            signal[n] = v2;
+            break;
+        }
+    }
+
+    svf->ic1eq = ic1eq;
+    svf->ic2eq = ic2eq;
+}
+
+void Filter_Ladder_Init(struct filterLadderT *const ladder)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        ladder->s[i] = 0.0f;
+    }
+    ladder->k = Filter_LadderK(0.0f);
+    ladder->cutoff = 1.0f;
+}
+
+void Filter_Ladder_SetReso(struct filterLadderT *const ladder, float reso)
+{
+    ladder->k = Filter_LadderK(reso);
+}
+
+/*
+ * four one-pole low pass stages with feedback, the feedback loop is solved per sample:
+ * y4 = (G^4 * x + S) / (1 + k * G^4)
+ */
+void Filter_Ladder_Process_Buffer(float *const signal, struct filterLadderT *const ladder, const float *cutoff, uint32_t len)
+{
+    const float k = ladder->k;
+    float s1 = ladder->s[0];
+    float s2 = ladder->s[1];
+    float s3 = ladder->s[2];
+    float s4 = ladder->s[3];
+    float G = Filter_ZdfLookup(zdfOnePole, ladder->cutoff);
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        if (cutoff != NULL)
+        {
+            G = Filter_ZdfLookup(zdfOnePole, cutoff[n]);
+        }
+
+        const float G2 = G * G;
+        const float G4 = G2 * G2;
+        const float S = (1.0f - G) * (((G * s1 + s2) * G + s3) * G + s4);
+        const float y4 = (G4 * signal[n] + S) * Filter_ZdfRecip(1.0f + k * G4);
+
+        float u = signal[n] - k * y4;
+        float v;
+
+        v = (u - s1) * G;
+        u = v + s1;
+        s1 = u + v;
+
+        v = (u - s2) * G;
+        u = v + s2;
+        s2 = u + v;
+
+        v = (u - s3) * G;
+        u = v + s3;
+        s3 = u + v;
+
+        v = (u - s4) * G;
+        u = v + s4;
+        s4 = u + v;
+
+        signal[n] = u;
+    }
+
+    ladder->s[0] = s1;
+    ladder->s[1] = s2;
+    ladder->s[2] = s3;
+    ladder->s[3] = s4;
+}
+
+void Filter_Svf_Init(struct filterSvfQ16T *const svf)
+{
+    svf->ic1eq = 0;
+    svf->ic2eq = 0;
+    svf->reso = 0;
+    svf->cutoff.s16 = INT16_MAX;
+}
+
+static uint8_t Filter_ResoStepQ16(Q1_14 reso)
+{
+    int32_t r = ((int32_t)reso.s16 * (FILTER_ZDF_Q16_RESO_CNT - 1) + (1 << 13)) >> 14;
+    return (r < 0) ? 0 : ((r >= FILTER_ZDF_Q16_RESO_CNT) ? (FILTER_ZDF_Q16_RESO_CNT - 1) : r);
+}
+
+void Filter_Svf_SetReso(struct filterSvfQ16T *const svf, Q1_14 reso)
+{
+    svf->reso = Filter_ResoStepQ16(reso);
+}
+
+void Filter_Svf_Process_Buffer(Q1_14 *const signal, struct filterSvfQ16T *const svf, const Q1_14 *cutoff, uint32_t len, uint8_t mode)
+{
+    const struct zdfSvfCoeffQ16 *table = &zdfSvfQ16[svf->reso * ZDF_Q16_CNT];
+    const int32_t k = (int32_t)(Filter_SvfK((float)svf->reso / (float)(FILTER_ZDF_Q16_RESO_CNT - 1)) * ZDF_Q16_ONE);
+    int32_t ic1eq = svf->ic1eq;
+    int32_t ic2eq = svf->ic2eq;
+    const struct zdfSvfCoeffQ16 *coeff = &table[Filter_ZdfIndexQ16(svf->cutoff)];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        if (cutoff != NULL)
+        {
+            coeff = &table[Filter_ZdfIndexQ16(cutoff[n])];
+        }
+
+        const int32_t x = (int32_t)signal[n].s16 * (1 << ZDF_Q16_STATE);
+        const int32_t v3 = x - ic2eq;
+        const int32_t v1 = Filter_MulQ16(coeff->a1, ic1eq) + Filter_MulQ16(coeff->a2, v3);
+        const int32_t v2 = ic2eq + Filter_MulQ16(coeff->a2, ic1eq) + Filter_MulQ16(coeff->a3, v3);
+        ic1eq = Filter_LimitQ16(2 * v1 - ic1eq);
+        ic2eq = Filter_LimitQ16(2 * v2 - ic2eq);
+
+        int32_t out;
+        switch (mode)
+        {
+        case filter_svf_bp:
+            out = v1;
+            break;
+        case filter_svf_hp:
+            out = x - Filter_MulQ16(k, v1) - v2;
+            break;
+        case filter_svf_notch:
+            out = x - Filter_MulQ16(k, v1);
+            break;
+        default:
+            out = v2;
+            break;
+        }
+        signal[n].s16 = Filter_SatQ16(out);
+    }
+
+    svf->ic1eq = ic1eq;
+    svf->ic2eq = ic2eq;
+}
+
+void Filter_Ladder_Init(struct filterLadderQ16T *const ladder)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        ladder->s[i] = 0;
+    }
+    ladder->reso = 0;
+    ladder->cutoff.s16 = INT16_MAX;
+}
+
+void Filter_Ladder_SetReso(struct filterLadderQ16T *const ladder, Q1_14 reso)
+{
+    ladder->reso = Filter_ResoStepQ16(reso);
+}
+
+void Filter_Ladder_Process_Buffer(Q1_14 *const signal, struct filterLadderQ16T *const ladder, const Q1_14 *cutoff, uint32_t len)
+{
+    const struct zdfLadderCoeffQ16 *table = &zdfLadderQ16[ladder->reso * ZDF_Q16_CNT];
+    const int32_t k = (int32_t)(Filter_LadderK((float)ladder->reso / (float)(FILTER_ZDF_Q16_RESO_CNT - 1)) * ZDF_Q16_ONE);
+    int32_t s1 = ladder->s[0];
+    int32_t s2 = ladder->s[1];
+    int32_t s3 = ladder->s[2];
+    int32_t s4 = ladder->s[3];
+    const struct zdfLadderCoeffQ16 *coeff = &table[Filter_ZdfIndexQ16(ladder->cutoff)];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        if (cutoff != NULL)
+        {
+            coeff = &table[Filter_ZdfIndexQ16(cutoff[n])];
+        }
+
+        const int32_t G = coeff->G;
+        const int32_t G2 = Filter_MulQ16(G, G);
+        const int32_t G4 = Filter_MulQ16(G2, G2);
+        const int32_t x = (int32_t)signal[n].s16 * (1 << ZDF_Q16_STATE);
+        const int32_t S = Filter_MulQ16(ZDF_Q16_ONE - G, Filter_MulQ16(Filter_MulQ16(Filter_MulQ16(G, s1) + s2, G) + s3, G) + s4);
+        const int32_t y4 = Filter_LimitQ16(Filter_MulQ16(coeff->norm, Filter_MulQ16(G4, x) + S));
+
+        /* the feedback and every stage are saturated, this keeps reso = 1 (k = 4) within int32 */
+        int32_t u = Filter_LimitQ16(x - Filter_MulQ16(k, y4));
+        int32_t v;
+
+        v = Filter_MulQ16(u - s1, G);
+        u = v + s1;
+        s1 = Filter_LimitQ16(u + v);
+
+        v = Filter_MulQ16(Filter_LimitQ16(u) - s2, G);
+        u = v + s2;
+        s2 = Filter_LimitQ16(u + v);
+
+        v = Filter_MulQ16(Filter_LimitQ16(u) - s3, G);
+        u = v + s3;
+        s3 = Filter_LimitQ16(u + v);
+
+        v = Filter_MulQ16(Filter_LimitQ16(u) - s4, G);
+        u = v + s4;
+        s4 = Filter_LimitQ16(u + v);
+
+        signal[n].s16 = Filter_SatQ16(u);
+    }
+
+    ladder->s[0] = s1;
+    ladder->s[1] = s2;
+    ladder->s[2] = s3;
+    ladder->s[3] = s4;
+}
+
+/*
+ * Q1_14 biquad, direct form I
+ * y = (b0 * x0 + b1 * x1 + b2 * x2 - a0 * y1 - a1 * y2 + 2^13) >> 14, saturated
+ */
+void Filter_Biquad_Init(struct filterBiquadQ16T *const filterP, struct filterCoeffQ16T *const filterC)
+{
+    filterP->filterCoeff = filterC;
+    Filter_Biquad_Reset(filterP);
+}
+
+void Filter_Biquad_Reset(struct filterBiquadQ16T *const filterP)
+{
+    filterP->x[0] = 0;
+    filterP->x[1] = 0;
+    filterP->y[0] = 0;
+    filterP->y[1] = 0;
+}
+
+/* -2.0 can not be negated in Q1_14 */
+static inline int16_t Filter_NegQ16(Q1_14 a)
+{
+    return (a.s16 == INT16_MIN) ? INT16_MAX : -a.s16;
+}
+
+void Filter_Biquad_Process_Buffer_Ref(Q1_14 *const signal, struct filterBiquadQ16T *const filterP, uint32_t len)
+{
+    const int32_t b0 = filterP->filterCoeff->bNorm[0].s16;
+    const int32_t b1 = filterP->filterCoeff->bNorm[1].s16;
+    const int32_t b2 = filterP->filterCoeff->bNorm[2].s16;
+    const int32_t na0 = Filter_NegQ16(filterP->filterCoeff->aNorm[0]);
+    const int32_t na1 = Filter_NegQ16(filterP->filterCoeff->aNorm[1]);
+
+    int32_t x1 = filterP->x[0];
+    int32_t x2 = filterP->x[1];
+    int32_t y1 = filterP->y[0];
+    int32_t y2 = filterP->y[1];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        const int32_t x0 = signal[n].s16;
+
+        /* unsigned to wrap around like the 32 bit accumulator of SMLAD */
+        uint32_t acc = 1UL << 13;
+        acc += (uint32_t)(b0 * x0);
+        acc += (uint32_t)(b1 * x1);
+        acc += (uint32_t)(b2 * x2);
+        acc += (uint32_t)(na0 * y1);
+        acc += (uint32_t)(na1 * y2);
+
+        int32_t y0 = ((int32_t)acc) >> 14;
+        y0 = (y0 > INT16_MAX) ? INT16_MAX : ((y0 < INT16_MIN) ? INT16_MIN : y0);
+
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+
+        signal[n].s16 = y0;
+    }
+
+    filterP->x[0] = x1;
+    filterP->x[1] = x2;
+    filterP->y[0] = y1;
+    filterP->y[1] = y2;
+}
+
+#ifdef FILTER_Q16_DSP
+/*
+ * two SMLAD and one SMLABB per sample, the samples are packed in pairs:
+ * (x0, x1) * (b0, b1), (x2, y1) * (b2, -a0), y2 * -a1
+ */
+void Filter_Biquad_Process_Buffer(Q1_14 *const signal, struct filterBiquadQ16T *const filterP, uint32_t len)
+{
+    const uint32_t b01 = __pkhbt((uint16_t)filterP->filterCoeff->bNorm[0].s16, filterP->filterCoeff->bNorm[1].s16, 16);
+    const uint32_t b2na0 = __pkhbt((uint16_t)filterP->filterCoeff->bNorm[2].s16, Filter_NegQ16(filterP->filterCoeff->aNorm[0]), 16);
+    const int32_t na1 = Filter_NegQ16(filterP->filterCoeff->aNorm[1]);
+
+    int32_t x1 = filterP->x[0];
+    int32_t x2 = filterP->x[1];
+    int32_t y1 = filterP->y[0];
+    int32_t y2 = filterP->y[1];
+
+    for (uint32_t n = 0; n < len; n++)
+    {
+        const int32_t x0 = signal[n].s16;
+
+        int32_t acc = __smlad(__pkhbt(x0, x1, 16), b01, 1L << 13);
+        acc = __smlad(__pkhbt(x2, y1, 16), b2na0, acc);
+        acc = __smlabb(y2, na1, acc);
+
+        const int32_t y0 = __ssat(acc >> 14, 16);
+
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+
+        signal[n].s16 = y0;
+    }
+
+    filterP->x[0] = x1;
+    filterP->x[1] = x2;
+    filterP->y[0] = y1;
+    filterP->y[1] = y2;
+}
+#else
+void Filter_Biquad_Process_Buffer(Q1_14 *const signal, struct filterBiquadQ16T *const filterP, uint32_t len)
+{
+    Filter_Biquad_Process_Buffer_Ref(signal, filterP, len);
+}
+#endif
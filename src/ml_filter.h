@@ -73,6 +73,54 @@ struct filterProcT
     float w[3];
 };
 
+/*
+ * filter bank, FILTER_BANK_LANES independent filters (e.g. one per voice) are processed in lockstep
+ * - the state is kept per lane which allows to use SIMD (SSE, NEON) for all lanes at once
+ * - the coefficients are read once per buffer
+ * - the result is bit exact to Filter_Process_Buffer of each lane when compiled with -ffp-contract=off,
+ *   otherwise the scalar version may be contracted to fused multiply adds and differs by rounding
+ */
+#ifndef FILTER_BANK_LANES
+#define FILTER_BANK_LANES   4
+#endif
+
+struct filterBankT
+{
+    struct filterCoeffT *filterCoeff[FILTER_BANK_LANES];
+    float w[2][FILTER_BANK_LANES];
+};
+
+/*
+ * coefficient table over cutoff and resonance, filled once by one of the Filter_Calculate functions
+ * - the poles are interpolated as radius and angle, the numerator coefficients linear
+ *   (radius < 1 keeps the filter stable, the resonance peak moves smoothly with the cutoff)
+ * - the resonance axis is linear in 1 / reso, this follows the pole radius
+ * - the table expects complex poles (reso >= 0.5 for the low pass)
+ * - memory: FILTER_TABLE_CUTOFF_CNT * FILTER_TABLE_RESO_CNT * 20 bytes on the heap
+ */
+#ifndef FILTER_TABLE_CUTOFF_CNT
+#define FILTER_TABLE_CUTOFF_CNT 65
+#endif
+#ifndef FILTER_TABLE_RESO_CNT
+#define FILTER_TABLE_RESO_CNT   17
+#endif
+
+typedef void (*filterCalcFn)(float c, float reso, struct filterCoeffT *const filterC);
+
+struct filterPoleT
+{
+    float bNorm[3];
+    float radius;
+    float angle; /* half of the pole angle */
+};
+
+struct filterCoeffTableT
+{
+    struct filterPoleT *pole; /* [reso][cutoff] */
+    float invResoMin;
+    float resoScale; /* entries per unit of 1 / reso */
+};
+
 struct filterCoeffQ16T
 {
     union
@@ -93,6 +141,19 @@ struct filterProcQ16T
     Q1_14 w[3];
 };
 
+/*
+ * Q1_14 biquad in direct form I, the structure maps to the dual 16 bit MAC (SMLAD) of Cortex-M4/M7
+ * - Filter_Biquad_Process_Buffer uses the DSP instructions when __ARM_FEATURE_DSP is available
+ * - Filter_Biquad_Process_Buffer_Ref is the portable reference with identical results
+ *   (32 bit accumulator wraps like SMLAD, rounding, saturation to 16 bit)
+ */
+struct filterBiquadQ16T
+{
+    struct filterCoeffQ16T *filterCoeff;
+    int16_t x[2]; /* x[n-1], x[n-2] */
+    int16_t y[2]; /* y[n-1], y[n-2] */
+};
+
 
 #define Filter_Calculate(...)   Filter_CalculateLowPass(__VA_ARGS__)
 
@@ -111,6 +172,15 @@ void Filter_CalculateNotch(float c, float reso, struct filterCoeffT *const filte
 
 void Filter_Process(float *const signal, struct filterProcT *const filterP);
 void Filter_Process_Buffer(float *const signal, struct filterProcT *const filterP, uint32_t len);
+void Filter_Process_Buffer(float *const signal, struct filterProcT *const filterP, struct filterCoeffT *const filterCur, uint32_t len);
+
+bool Filter_CoeffTable_Init(struct filterCoeffTableT *const table, filterCalcFn calc, float resoMin, float resoMax);
+void Filter_CoeffTable_Lookup(const struct filterCoeffTableT *const table, float c, float reso, struct filterCoeffT *const filterC);
+
+void Filter_Bank_Init(struct filterBankT *const bank, struct filterCoeffT *const filterC);
+void Filter_Bank_SetCoeff(struct filterBankT *const bank, uint32_t lane, struct filterCoeffT *const filterC);
+void Filter_Bank_Reset(struct filterBankT *const bank);
+void Filter_Bank_Process_Buffer(float *const *signal, struct filterBankT *const bank, uint32_t len);
 
 
 void Filter_Init(struct filterProcQ16T *const filterP, struct filterCoeffQ16T *const filterC);
@@ -126,6 +196,88 @@ void Filter_CalculateNotch(Q1_14 c, Q1_14 reso, struct filterCoeffQ16T *const fi
 void Filter_Process(Q1_14 *const signal, struct filterProcQ16T *const filterP);
 void Filter_Process_Buffer(Q1_14 *const signal, struct filterProcQ16T *const filterP, uint32_t len);
 
+void Filter_Biquad_Init(struct filterBiquadQ16T *const filterP, struct filterCoeffQ16T *const filterC);
+void Filter_Biquad_Reset(struct filterBiquadQ16T *const filterP);
+void Filter_Biquad_Process_Buffer(Q1_14 *const signal, struct filterBiquadQ16T *const filterP, uint32_t len);
+void Filter_Biquad_Process_Buffer_Ref(Q1_14 *const signal, struct filterBiquadQ16T *const filterP, uint32_t len);
+
+
+/*
+ * zero delay feedback filters (topology preserving transform)
+ * - stable under fast modulation, the cutoff can be changed every sample (cutoff buffer)
+ *   or once per buffer (cutoff buffer NULL, the cutoff member is used)
+ * - cutoff 0..1 uses the same curve as Filter_CalculateLowPass
+ * - reso 0..1, the svf and the ladder start to self oscillate close to 1
+ *   (the Q1_14 versions saturate their states to +-32.0 to stay within int32)
+ * - per sample coefficient update: float one table lookup and a reciprocal (128 entry table
+ *   and two newton steps, no division), Q1_14 one table lookup
+ * - the Q1_14 versions are using a table per resonance step (Filter_Zdf_InitQ16, about 20 kByte heap)
+ */
+#ifndef FILTER_ZDF_TABLE_BIT
+#define FILTER_ZDF_TABLE_BIT    8
+#endif
+#ifndef FILTER_ZDF_Q16_TABLE_BIT
+#define FILTER_ZDF_Q16_TABLE_BIT    7
+#endif
+#ifndef FILTER_ZDF_Q16_RESO_CNT
+#define FILTER_ZDF_Q16_RESO_CNT 8
+#endif
+
+enum filter_svf_mode_e
+{
+    filter_svf_lp,
+    filter_svf_bp,
+    filter_svf_hp,
+    filter_svf_notch,
+};
+
+struct filterSvfT
+{
+    float ic1eq;
+    float ic2eq;
+    float k; /* damping, 2 - 1.99 * reso */
+    float cutoff;
+};
+
+struct filterLadderT
+{
+    float s[4];
+    float k; /* feedback, 4 * reso */
+    float cutoff;
+};
+
+struct filterSvfQ16T
+{
+    int32_t ic1eq; /* state has 8 additional fractional bits */
+    int32_t ic2eq;
+    uint8_t reso; /* resonance step */
+    Q1_14 cutoff;
+};
+
+struct filterLadderQ16T
+{
+    int32_t s[4];
+    uint8_t reso;
+    Q1_14 cutoff;
+};
+
+void Filter_Zdf_Init(void);
+bool Filter_Zdf_InitQ16(void);
+
+void Filter_Svf_Init(struct filterSvfT *const svf);
+void Filter_Svf_SetReso(struct filterSvfT *const svf, float reso);
+void Filter_Svf_Process_Buffer(float *const signal, struct filterSvfT *const svf, const float *cutoff, uint32_t len, uint8_t mode);
+void Filter_Ladder_Init(struct filterLadderT *const ladder);
+void Filter_Ladder_SetReso(struct filterLadderT *const ladder, float reso);
+void Filter_Ladder_Process_Buffer(float *const signal, struct filterLadderT *const ladder, const float *cutoff, uint32_t len);
+
+void Filter_Svf_Init(struct filterSvfQ16T *const svf);
+void Filter_Svf_SetReso(struct filterSvfQ16T *const svf, Q1_14 reso);
+void Filter_Svf_Process_Buffer(Q1_14 *const signal, struct filterSvfQ16T *const svf, const Q1_14 *cutoff, uint32_t len, uint8_t mode);
+void Filter_Ladder_Init(struct filterLadderQ16T *const ladder);
+void Filter_Ladder_SetReso(struct filterLadderQ16T *const ladder, Q1_14 reso);
+void Filter_Ladder_Process_Buffer(Q1_14 *const signal, struct filterLadderQ16T *const ladder, const Q1_14 *cutoff, uint32_t len);
+
 
 #endif /* ML_FILTER_H_ */
 
@@ -52,23 +52,67 @@
 #endif
 
 
+#include <ml_fm.h>
 #include <ml_utils.h>
 #include <ml_status.h>
 
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
-#ifndef GLOBAL_SINE
+#if !defined(GLOBAL_SINE) || defined(FM_FIXED_POINT_ENABLED)
 #include <stdlib.h>
 #endif
 
-static float sample_rate = 0;
+/*
+ * the sine table does not depend on the sample rate, it is shared by all FmEngine instances
+ *
+ * FM_FIXED_POINT_ENABLED selects the integer render path for targets without FPU
+ * - Q15 samples, int16_t sine table and integer phase modulation
+ * - float is only used per block (gain, pitch) and for the final output
+ */
+#ifdef FM_FIXED_POINT_ENABLED
+typedef uint32_t fm_phase_mod_t;
+#define FM_SAMPLE_ONE   32768.0f
+#define FM_OP_GAIN      32768.0f /* gain is Q15 */
+#else
+typedef float fm_phase_mod_t;
+#define FM_SAMPLE_ONE   1.0f
+#define FM_OP_GAIN      (1.0f / 32768.0f) /* includes the scaling of fmEgPow2 */
+#endif
 
-#ifdef GLOBAL_SINE
+#if defined(GLOBAL_SINE) && !defined(FM_FIXED_POINT_ENABLED)
 extern float *sine;
 #endif
-#ifdef ARDUINO_RUNNING_CORE
+/*
+ * quality of the operator sine, FM_SINE_BIT and FM_SINE_INTERPOLATION can also be set directly
+ * - 0: 10 bit table
+ * - 1: 11 bit table (ESP32) or 12 bit table (default)
+ * - 2: 10 bit table, interpolated
+ * - 3: 12 bit table, interpolated
+ */
+#ifdef FM_SINE_QUALITY
+#if FM_SINE_QUALITY == 0
+#ifndef FM_SINE_BIT
+#define FM_SINE_BIT 10UL
+#endif
+#elif FM_SINE_QUALITY == 2
+#ifndef FM_SINE_BIT
+#define FM_SINE_BIT 10UL
+#endif
+#define FM_SINE_INTERPOLATION
+#elif FM_SINE_QUALITY == 3
+#ifndef FM_SINE_BIT
+#define FM_SINE_BIT 12UL
+#endif
+#define FM_SINE_INTERPOLATION
+#endif
+#endif
+
+#ifdef FM_SINE_BIT
+#define SINE_BIT    FM_SINE_BIT
+#elif defined(ARDUINO_RUNNING_CORE)
 #define SINE_BIT    11UL /* lower resolution required due to the fact that heap blocks are smaller */
 #else
 #define SINE_BIT    12UL
@@ -77,12 +121,59 @@ extern float *sine;
 #define SINE_CNT    (1<<SINE_BIT)
 #define SINE_MSK    ((1<<SINE_BIT)-1)
 #define SINE_I(i)   ((i) >> (32 - SINE_BIT)) /* & SINE_MSK */
+#define SINE_FRAC_BIT   (32 - SINE_BIT) /* phase bits between two table entries */
+
+#ifdef FM_FIXED_POINT_ENABLED
+static int16_t *sineQ15 = NULL;
+
+static void Sine_Init(void)
+{
+    if (sineQ15 != NULL)
+    {
+        return;
+    }
+
+    uint32_t memSize = sizeof(int16_t) * SINE_CNT;
+    sineQ15 = (int16_t *)malloc(memSize);
+    if (sineQ15 == NULL)
+    {
+        Status_LogMessage("not enough heap memory for sine buffer!\n");
+    }
+    for (int i = 0; i < SINE_CNT; i++)
+    {
+        sineQ15[i] = (int16_t)(32767.0 * sin(i * 2.0 * M_PI / SINE_CNT));
+    }
+}
 
+/* used by the lfo, the full turn is 1 << 32 */
+static float SineNorm(uint32_t pos)
+{
+    return sineQ15[SINE_I(pos)] * (1.0f / 32767.0f);
+}
+
+static int32_t SineQ15U32(uint32_t pos)
+{
+#ifdef FM_SINE_INTERPOLATION
+    uint32_t i = SINE_I(pos);
+    int32_t a = sineQ15[i];
+    int32_t b = sineQ15[(i + 1) & SINE_MSK];
+    int32_t frac = (pos >> (SINE_FRAC_BIT - 15)) & 0x7FFF;
+    return a + (((b - a) * frac) >> 15);
+#else
+    return sineQ15[SINE_I(pos)];
+#endif
+}
+#else
 #ifndef GLOBAL_SINE
 static float *sine = NULL;
 
 static void Sine_Init(void)
 {
+    if (sine != NULL)
+    {
+        return;
+    }
+
     uint32_t memSize = sizeof(float) * SINE_CNT;
     sine = (float *)malloc(memSize);
     if (sine == NULL)
@@ -96,16 +187,25 @@ static void Sine_Init(void)
 }
 #endif
 
-static float SineNorm(float alpha_div2pi)
+/* used by the lfo, the full turn is 1 << 32 */
+static float SineNorm(uint32_t pos)
 {
-    uint32_t index = ((uint32_t)(alpha_div2pi * ((float)SINE_CNT))) % SINE_CNT;
-    return sine[index];
+    return sine[SINE_I(pos)];
 }
 
 static float SineNormU32(uint32_t pos)
 {
+#ifdef FM_SINE_INTERPOLATION
+    uint32_t i = SINE_I(pos);
+    float a = sine[i];
+    float b = sine[(i + 1) & SINE_MSK];
+    float frac = (float)(pos & ((1UL << SINE_FRAC_BIT) - 1)) * (1.0f / (float)(1UL << SINE_FRAC_BIT));
+    return a + (b - a) * frac;
+#else
     return sine[SINE_I(pos)];
+#endif
 }
+#endif /* FM_FIXED_POINT_ENABLED */
 
 #ifndef ARDUINO
 float millis()
@@ -119,12 +219,11 @@ float millis()
 #define OP3 1
 #define OP4 0
 
-#define MIDI_CH_CNT 16
+#define MIDI_CH_CNT FM_MIDI_CH_CNT
 
-#define FM_VOICE_CNT    6
-
-#define fabs(a) (a>0.0)?(a):(-a)
-#define fmax(a,b) (a>b)?(a):(b)
+#ifdef FM_FIXED_POINT_ENABLED
+#define FM_MIX_BLOCK    48 /* size of the integer mix buffer on the stack */
+#endif
 
 enum ssg_eg_e
 {
@@ -139,203 +238,319 @@ enum ssg_eg_e
     ssgeg_once_high_inv
 };
 
-struct op_properties_s
-{
-    float mw; /* mod wheel  to amplitude */
-    float am; /* amplitude modulation toggle, from lfo-ams */
-
-    uint32_t ar; /* attack */
-    uint32_t d1r; /* decay until d2l */
-    uint32_t d2r; /* */
-    float d2l; /* decay level */
-    uint32_t rr;
-    uint32_t rs; /* key rate dings, make envelope faster or slower */
-
-    float ssgeg; /* software controlled sound generator - envelope behavior */
-    float mul;
-
-    float mul_fine;
-    float mul_coarse;
-
-    float fixed;
-    float dt; /* detune */
-    float vel; /* hm for what is this good for? */
-    float tl; /* total level: envelope amplitude */
-
-    float vel_to_tl; /* addon to push MIDI vel to tl */
-};
-
-struct custom_properties_s
-{
-    float feedback; /* op1 feedback */
-
-    float lfo_enable;
-    float lfo_speed;
-    float fms; /* pitch modulation sensitivity */
-    float fmsmw;
-    float ams; /* amplitude modulation sensitivity */
-
-    float legato_retrig;
-    float pitchbend_range;
-    float volume;
-    float alg;
-};
-
-typedef uint8_t envState_t;
-
 #define ENV_ATTACK  (envState_t)0
 #define ENV_DECAY1  (envState_t)1
 #define ENV_DECAY2  (envState_t)2
 #define ENV_RELEASE (envState_t)3
 #define ENV_OFF     (envState_t)4
+#define ENV_HOLD    (envState_t)5 /* level is held by the ssg-eg until release */
 
-struct synthTone_s
+/*
+ * the envelope is calculated as integer attenuation (similar to the YM2612)
+ * - 10 bit attenuation, 64 steps are 6 dB, 0x3FF is quiet
+ * - the amplitude is taken from fmEgPow2, so decay and release are exponential
+ * - the attack is an exponential approach to zero attenuation
+ * - ar, d1r, d2r and rr multiplied by rs are the samples to pass the full range
+ */
+#define FM_EG_BITS  10
+#define FM_EG_FRAC  20 /* fractional bits of the attenuation */
+#define FM_EG_MSK   ((1UL << FM_EG_BITS) - 1)
+#define FM_EG_MAX   (FM_EG_MSK << FM_EG_FRAC)
+#define FM_EG_SSG   (0x200UL << FM_EG_FRAC) /* ssg-eg turns at -48 dB */
+#define FM_EG_INF   0x7FFFFFFF
+
+/* 32768 * 2^(-i/64) */
+static const uint16_t fmEgPow2[64] =
 {
-    float pitch;
-    float pitchCalc;
+    32768, 32415, 32066, 31720, 31379, 31041, 30706, 30376, 30048, 29725, 29405, 29088, 28774, 28464, 28158, 27855,
+    27554, 27258, 26964, 26674, 26386, 26102, 25821, 25543, 25268, 24995, 24726, 24460, 24196, 23936, 23678, 23423,
+    23170, 22921, 22674, 22430, 22188, 21949, 21713, 21479, 21247, 21019, 20792, 20568, 20347, 20127, 19911, 19696,
+    19484, 19274, 19066, 18861, 18658, 18457, 18258, 18061, 17867, 17674, 17484, 17296, 17109, 16925, 16743, 16562,
+};
 
-    float out;
-    float in;
+/* 32768 / (1 + (i + 1) / 64), rounded down to never overshoot the target */
+static const uint16_t fmEgRecip[64] =
+{
+    32263, 31775, 31300, 30840, 30393, 29959, 29537, 29127, 28728, 28339, 27962, 27594, 27235, 26886, 26546, 26214,
+    25890, 25575, 25266, 24966, 24672, 24385, 24105, 23831, 23563, 23301, 23045, 22795, 22550, 22310, 22075, 21845,
+    21620, 21399, 21183, 20971, 20763, 20560, 20360, 20164, 19972, 19784, 19599, 19418, 19239, 19065, 18893, 18724,
+    18558, 18396, 18236, 18078, 17924, 17772, 17623, 17476, 17331, 17189, 17050, 16912, 16777, 16644, 16513, 16384,
+};
 
-    uint32_t pos;
-    float sine_preoout;
+/* 64 * log2(1 + i / 64) */
+static const uint8_t fmEgLog2[64] =
+{
+    0, 1, 3, 4, 6, 7, 8, 10, 11, 12, 13, 15, 16, 17, 18, 19,
+    21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 34, 35, 35, 36,
+    37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 47, 48, 49, 50, 51,
+    52, 52, 53, 54, 55, 56, 56, 57, 58, 59, 60, 60, 61, 62, 63, 63,
+};
 
-    float lvl_env;
-    float lvl_add;
-    envState_t state;
-    int stateLen;
+/* 256 * 2^(-i/4) */
+static const uint16_t fmEgKeyScale[4] = { 256, 215, 181, 152 };
 
-    float vel;
 
-    struct op_properties_s *op_prop;
-};
 
-struct synthVoice_s
-{
-    struct synthTone_s op[4];
-    bool active;
+static bool FmSynth_EnvStateProcess(struct synthVoice_s *voice, uint32_t len);
+static fm_sample_t FmSynth_AlgMixProcess(fm_sample_t *in, const fm_sample_t *out, int algo, fm_sample_t feedback);
 
-    uint8_t midiNote;
-    uint8_t midiCh;
-    float out;
-    float outSlow;
 
-    struct channelSettingParam_s *settings;
-};
+/*
+ * returns 2^32 / len, len has to be 2 or greater
+ */
+static inline uint32_t FmSynth_EgRecip(uint32_t len)
+{
+    uint32_t e = 31 - __builtin_clz(len);
+    uint32_t m = ((len << (31 - e)) >> 25) & 63;
+    uint32_t r = fmEgRecip[m];
 
-struct synthVoice_s fmVoice[FM_VOICE_CNT];
+    return (e <= 17) ? (r << (17 - e)) : (r >> (e - 17));
+}
 
-struct channelSettingParam_s
+/*
+ * returns 64 * log2(v), v has to be 1 or greater
+ */
+static inline uint32_t FmSynth_EgLog2(uint32_t v)
 {
-    struct custom_properties_s props;
-    struct op_properties_s op_prop[4];
+    uint32_t e = 31 - __builtin_clz(v);
+    uint32_t m = ((v << (31 - e)) >> 25) & 63;
 
-    float fmFeedback;
+    return (e << 6) + fmEgLog2[m];
+}
 
-    int algo;
+/*
+ * returns the attenuation of a linear level (1.0 is 0 dB)
+ */
+static uint32_t FmSynth_EgAttFromLevel(float level)
+{
+    if (level >= 1.0f)
+    {
+        return 0;
+    }
 
-    bool mono;
-    bool legato;
+    uint32_t v = (uint32_t)(level * 65536.0f);
+    if (v == 0)
+    {
+        return FM_EG_MAX;
+    }
 
-    uint8_t notes[16];
-    uint8_t noteStackCnt;
-};
+    uint32_t att = (16 << 6) - FmSynth_EgLog2(v);
+    return (att < FM_EG_MSK) ? (att << FM_EG_FRAC) : FM_EG_MAX;
+}
 
-static uint32_t milliCnt = 0;
+/*
+ * returns the samples to pass the full attenuation range
+ * ks works like the rate scaling of the YM2612, each step of the key code shortens by 2^(1/4)
+ */
+static uint32_t FmSynth_EgLen(const struct synthVoice_s *voice, int op, uint32_t rate)
+{
+    const struct op_properties_s *op_prop = voice->op_prop[op];
+    uint32_t len = rate * op_prop->rs;
 
-static float modulationDepth = 0.0f;
-static float modulationSpeed = 5.0f;
-static float modulationPitch = 1.0f;
-static float pitchBendValue = 0.0f;
-#ifdef PRESSURE_SENSOR_ENABLED
-static float pressureValue = 0.0f;
-static float pressureValueFilt = 0.0f;
-#endif
-static float pitchMultiplier = 1.0f;
+    if (op_prop->ks > 0)
+    {
+        uint32_t kc = (voice->midiNote > 12) ? ((voice->midiNote - 12) / 3) : 0; /* similar to block and fnum of the YM2612 */
+        kc = (kc < 31) ? kc : 31;
+        uint32_t kr = kc >> (3 - ((op_prop->ks < 3) ? op_prop->ks : 3));
+        len = ((uint64_t)len * fmEgKeyScale[kr & 3]) >> (8 + (kr >> 2));
+    }
 
-static bool initChannelSetting = false;
-static uint32_t initChannelSettingCnt = 0;
+    return (len > 0) ? len : 1;
+}
 
-static struct channelSettingParam_s channelSettings[MIDI_CH_CNT];
+/*
+ * linear increase of the attenuation to target
+ * returns false when target has been already reached
+ */
+static bool FmSynth_EgLinear(struct synthVoice_s *voice, int op, uint32_t len, uint32_t target)
+{
+    uint32_t att = voice->eg_att[op];
 
-static struct channelSettingParam_s *currentChSetting = &channelSettings[0];
+    voice->eg_mul[op] = 0;
+    voice->eg_target[op] = target;
 
-static uint8_t selectedOp = OP4;
+    if (att >= target)
+    {
+        return false;
+    }
 
-static struct op_properties_s op_props_silent;
+    if (len < 2)
+    {
+        voice->eg_add[op] = target - att;
+        voice->stateLen[op] = 1;
+    }
+    else
+    {
+        voice->eg_add[op] = FmSynth_EgRecip(len) >> (32 - FM_EG_BITS - FM_EG_FRAC);
+        voice->stateLen[op] = (((uint64_t)(target - att) * len) + (1UL << (FM_EG_BITS + FM_EG_FRAC)) - 1) >> (FM_EG_BITS + FM_EG_FRAC);
+    }
 
-static float multiplierPitchToAddValue = 0; // ((float)(1ULL << 32ULL) / ((float)sample_rate));
+    return true;
+}
 
+/*
+ * ssg-eg event when the attenuation has reached FM_EG_SSG
+ * bit 0: hold, bit 1: alternate, bit 2: attack (same as the register bits of the YM2612)
+ */
+static void FmSynth_EgSsgEvent(struct synthVoice_s *voice, int op)
+{
+    uint8_t mode = voice->op_prop[op]->ssgeg - 1;
+    uint8_t attBit = (mode >> 2) & 1;
 
-static void FmSynth_ProcessOperator(struct synthTone_s *osc);
-static void FmSynth_EnvStateProcess(struct synthTone_s *osc);
-static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice);
+    if (mode & 1)
+    {
+        if (mode & 2)
+        {
+            voice->ssgToggle[op] = 1;
+        }
+        if (!(voice->ssgToggle[op] ^ attBit))
+        {
+            voice->eg_att[op] = FM_EG_MAX;
+        }
+        voice->state[op] = ENV_HOLD;
+    }
+    else
+    {
+        if (mode & 2)
+        {
+            voice->ssgToggle[op] ^= 1;
+        }
+        else
+        {
+            voice->pos[op] = 0;
+        }
+        voice->state[op] = ENV_ATTACK;
+    }
 
+    voice->ssgInv[op] = voice->ssgToggle[op] ^ attBit;
+}
 
-void FmSynth_ToneEnvUpdate(struct synthTone_s *tone)
+/*
+ * finishes the current envelope state
+ */
+static void FmSynth_EgNext(struct synthVoice_s *voice, int op)
 {
-    uint32_t attack = tone->op_prop->ar * tone->op_prop->rs;
-    attack = attack > 0 ? attack : 1;
-
-    uint32_t decay1 = tone->op_prop->d1r * tone->op_prop->rs;
-    decay1 = decay1 > 0 ? decay1 : 1;
+    voice->eg_att[op] = voice->eg_target[op];
 
-    uint32_t decay2 = tone->op_prop->d2r * tone->op_prop->rs;
-    decay2 = decay2 > 0 ? decay2 : 1;
-
-    uint32_t release = tone->op_prop->rr * tone->op_prop->rs;
-    release = release > 0 ? release : 1;
+    if ((voice->op_prop[op]->ssgeg != ssgeg_off) && (voice->eg_att[op] >= FM_EG_SSG)
+        && ((voice->state[op] == ENV_DECAY1) || (voice->state[op] == ENV_DECAY2)))
+    {
+        FmSynth_EgSsgEvent(voice, op);
+        return;
+    }
 
-    switch (tone->state)
+    switch (voice->state[op])
     {
     case ENV_ATTACK:
-        tone->lvl_add = 1.0f / (((float)attack));
-        tone->stateLen = attack;
+        voice->state[op] = ENV_DECAY1;
         break;
     case ENV_DECAY1:
-        tone->lvl_add = (tone->op_prop->d2l - tone->lvl_env) / (((float)decay1));
-        tone->stateLen = decay1;
+        voice->state[op] = ENV_DECAY2;
         break;
     case ENV_DECAY2:
-        tone->lvl_add = (0.0f - tone->lvl_env) / (((float)decay2));
-        tone->stateLen = decay2;
-        break;
     case ENV_RELEASE:
-        tone->lvl_add = (0.0f - tone->lvl_env) / (((float)release));
-        tone->stateLen = release;
+        voice->state[op] = ENV_OFF;
         break;
-    case ENV_OFF:
-        tone->lvl_add = 0;
-        tone->stateLen = 0;
-
-        tone->lvl_env = 0.0f; /* ensure output is quiet */
+    default:
         break;
+    }
+}
+
+/*
+ * prepares the current envelope state
+ * returns false when nothing is left to do in this state
+ */
+static bool FmSynth_EgEnter(struct synthVoice_s *voice, int op)
+{
+    const struct op_properties_s *op_prop = voice->op_prop[op];
+    bool ssg = op_prop->ssgeg != ssgeg_off;
+
+    voice->eg_add[op] = 0;
+    voice->eg_mul[op] = 0;
+
+    switch (voice->state[op])
+    {
+    case ENV_ATTACK:
+        {
+            uint32_t attack = FmSynth_EgLen(voice, op, op_prop->ar);
+            uint32_t idx = voice->eg_att[op] >> FM_EG_FRAC;
+
+            voice->eg_target[op] = 0;
+            if ((attack < 8) || (idx == 0))
+            {
+                return false;
+            }
+            /* ln(1024) / attack, full range is passed in attack samples */
+            voice->eg_mul[op] = ((uint64_t)FmSynth_EgRecip(attack) * 1774) >> 8;
+            /* attack * log2(idx) / 10 */
+            voice->stateLen[op] = (((uint64_t)attack * FmSynth_EgLog2(idx) * 6554) >> 22) + 1;
+        }
+        return true;
+    case ENV_DECAY1:
+        {
+            uint32_t target = FmSynth_EgAttFromLevel(op_prop->d2l);
+            if (ssg)
+            {
+                target = (target < FM_EG_SSG) ? target : FM_EG_SSG;
+            }
+            /* ssg-eg decays are running at four times the rate */
+            return FmSynth_EgLinear(voice, op, FmSynth_EgLen(voice, op, op_prop->d1r) >> (ssg ? 2 : 0), target);
+        }
+    case ENV_DECAY2:
+        return FmSynth_EgLinear(voice, op, FmSynth_EgLen(voice, op, op_prop->d2r) >> (ssg ? 2 : 0), ssg ? FM_EG_SSG : FM_EG_MAX);
+    case ENV_RELEASE:
+        if (voice->ssgInv[op])
+        {
+            /* continue with the level which has been audible */
+            uint32_t idx = voice->eg_att[op] >> FM_EG_FRAC;
+            voice->eg_att[op] = ((0x200 - idx) & FM_EG_MSK) << FM_EG_FRAC;
+            voice->ssgInv[op] = 0;
+        }
+        return FmSynth_EgLinear(voice, op, FmSynth_EgLen(voice, op, op_prop->rr), FM_EG_MAX);
+    case ENV_HOLD:
+        voice->eg_target[op] = voice->eg_att[op];
+        voice->stateLen[op] = FM_EG_INF;
+        return true;
+    case ENV_OFF:
+        voice->stateLen[op] = 0;
+        voice->eg_att[op] = FM_EG_MAX; /* ensure output is quiet */
+        voice->eg_target[op] = FM_EG_MAX;
+        voice->ssgInv[op] = 0;
+        return true;
 
     default:
-        tone->lvl_add = 0;
-        tone->stateLen = 1;
-        tone->state = ENV_OFF;
-        break;
+        voice->state[op] = ENV_OFF;
+        return false;
+    }
+}
+
+void FmSynth_ToneEnvUpdate(struct synthVoice_s *voice, int op)
+{
+    while (!FmSynth_EgEnter(voice, op))
+    {
+        FmSynth_EgNext(voice, op);
     }
 }
 
-void FmSynth_ToneInit(struct synthTone_s *tone, struct op_properties_s *op_props)
+void FmSynth_ToneInit(struct synthVoice_s *voice, int op, struct op_properties_s *op_props)
 {
-    tone->pos = 0;
-    tone->sine_preoout = 0.0f;
+    voice->pos[op] = 0;
+    voice->add[op] = 0;
 
-    tone->in = 0.0f;
-    tone->out = 0.0f;
+    voice->in[op] = 0.0f;
+    voice->out[op] = 0.0f;
 
-    tone->vel = 1.0f;
+    voice->vel[op] = 1.0f;
+    voice->gain[op] = 0.0f;
 
-    tone->lvl_env = 0.0f;
-    tone->lvl_add = 0.0f;
+    voice->state[op] = ENV_ATTACK;
+    voice->op_prop[op] = op_props;
 
-    tone->state = ENV_ATTACK;
-    tone->op_prop = op_props;
+    voice->eg_att[op] = FM_EG_MAX;
+    voice->ssgToggle[op] = 0;
+    voice->ssgInv[op] = (op_props->ssgeg != ssgeg_off) ? (((op_props->ssgeg - 1) >> 2) & 1) : 0;
 
-    FmSynth_ToneEnvUpdate(tone);
+    FmSynth_ToneEnvUpdate(voice, op);
 }
 
 void FmSynth_InitOpProps(struct op_properties_s *op_props)
@@ -346,6 +561,8 @@ void FmSynth_InitOpProps(struct op_properties_s *op_props)
     op_props->d2r = 32767;
     op_props->rr = 1;
     op_props->rs = 50.0f;
+    op_props->ks = 0;
+    op_props->ssgeg = ssgeg_off;
 
     op_props->am = 0;
 
@@ -361,16 +578,20 @@ void FmSynth_InitOpProps(struct op_properties_s *op_props)
     op_props->vel_to_tl = 0.0f;
 }
 
-void FmSynth_IntiVoice(struct synthVoice_s *voice)
+void FmEngine::InitVoice(struct synthVoice_s *voice)
 {
-    voice->out = 0.0f;
+    voice->pitch = 0.0f;
+    voice->pitchMultiplier = 0.0f;
+    voice->active = false;
     voice->midiCh = 0xff;
     voice->midiNote = 0xff;
     voice->settings = currentChSetting;
 
     for (int i = 0; i < 4; i++)
     {
-        FmSynth_ToneInit(&voice->op[i], &op_props_silent);
+        voice->add[i] = 0;
+        voice->addStep[i] = 0;
+        FmSynth_ToneInit(voice, i, &op_props_silent);
     }
 }
 
@@ -383,6 +604,12 @@ void FmSynth_InitChannelSettings(struct channelSettingParam_s *channelSettings)
     channelSettings->legato = false;
     channelSettings->noteStackCnt = 0;
 
+    channelSettings->props.lfo_enable = 0.0f;
+    channelSettings->props.lfo_speed = 5.0f;
+    channelSettings->props.fms = 0.0f;
+    channelSettings->props.fmsmw = 1.0f;
+    channelSettings->props.ams = 0.0f;
+
     for (int i = 0; i < 4; i++)
     {
         FmSynth_InitOpProps(&channelSettings->op_prop[i]);
@@ -390,979 +617,540 @@ void FmSynth_InitChannelSettings(struct channelSettingParam_s *channelSettings)
     channelSettings->op_prop[OP4].tl = 1.0f;
 }
 
-void FmSynth_Init(float sample_rate_in)
+static void FmSynth_VoiceListAdd(struct fmVoiceList_s *list, struct synthVoice_s *voice)
 {
-#ifndef GLOBAL_SINE
-    Sine_Init();
-#endif
-
-    sample_rate = sample_rate_in;
-    multiplierPitchToAddValue = ((float)(1ULL << 32ULL) / ((float)sample_rate));
-
-    FmSynth_InitOpProps(&op_props_silent);
-    op_props_silent.tl = 0.0f;
-    op_props_silent.d1r = 1;
-    op_props_silent.d2r = 1;
-
-    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    voice->list = list;
+    voice->next = NULL;
+    voice->prev = list->tail;
+    if (list->tail != NULL)
     {
-        FmSynth_InitChannelSettings(&channelSettings[ch]);
+        list->tail->next = voice;
+    }
+    else
+    {
+        list->head = voice;
     }
+    list->tail = voice;
+}
 
-    for (int j = 0; j < FM_VOICE_CNT; j++)
-    {
-        FmSynth_IntiVoice(&fmVoice[j]);
-    }
-
-    struct channelSettingParam_s *setting = &channelSettings[0];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0;
-    setting->op_prop[0].ar = 1.855923;
-    setting->op_prop[0].d1r = 1.855923;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767.000000;
-    setting->op_prop[0].rr = 1.855923;
-    setting->op_prop[0].rs = 50.000000;
-    setting->op_prop[0].tl = 1.000000;
-    setting->op_prop[0].mul = 2.500000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1.855923;
-    setting->op_prop[1].d1r = 1.855923;
-    setting->op_prop[1].d2l = 0.346456;
-    setting->op_prop[1].d2r = 32767.000000;
-    setting->op_prop[1].rr = 1.855923;
-    setting->op_prop[1].rs = 50.000000;
-    setting->op_prop[1].tl = 0.322834;
-    setting->op_prop[1].mul = 3.500000;
-    setting->op_prop[1].vel_to_tl = 0.614172;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1.855923;
-    setting->op_prop[2].d1r = 1.855923;
-    setting->op_prop[2].d2l = 0.401574;
-    setting->op_prop[2].d2r = 32767.000000;
-    setting->op_prop[2].rr = 1.855923;
-    setting->op_prop[2].rs = 50.000000;
-    setting->op_prop[2].tl = 0.047244;
-    setting->op_prop[2].mul = 11.000000;
-    setting->op_prop[2].vel_to_tl = 0.999998;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1.855923;
-    setting->op_prop[3].d1r = 1.855923;
-    setting->op_prop[3].d2l = 1.000000;
-    setting->op_prop[3].d2r = 32767.000000;
-    setting->op_prop[3].rr = 1.855923;
-    setting->op_prop[3].rs = 50.000000;
-    setting->op_prop[3].tl = 0.000000;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-
-    setting = &channelSettings[1];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 1;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1023;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 1.000000;
-    setting->op_prop[0].mul = 2.500000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 1;
-    setting->op_prop[1].d2l = 0.346456;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1023;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.322834;
-    setting->op_prop[1].mul = 3.500000;
-    setting->op_prop[1].vel_to_tl = 0.614172;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 1;
-    setting->op_prop[2].d2l = 0.401574;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1023;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.047244;
-    setting->op_prop[2].mul = 11.000000;
-    setting->op_prop[2].vel_to_tl = 0.999998;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 1;
-    setting->op_prop[3].d2l = 1.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.000000;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+static void FmSynth_VoiceListRemove(struct synthVoice_s *voice)
+{
+    struct fmVoiceList_s *list = voice->list;
 
-    /*
-     * like a guitar
-     */
-    setting = &channelSettings[2];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 1.000000;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 147;
-    setting->op_prop[1].d2l = 0.637794;
-    setting->op_prop[1].d2r = 2386;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.354330;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 1239;
-    setting->op_prop[2].d2l = 0.999998;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.181102;
-    setting->op_prop[2].mul = 1.250000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 26;
-    setting->op_prop[3].d2l = 0.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.291338;
-    setting->op_prop[3].mul = 0.630000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+    if (voice->prev != NULL)
+    {
+        voice->prev->next = voice->next;
+    }
+    else
+    {
+        list->head = voice->next;
+    }
+    if (voice->next != NULL)
+    {
+        voice->next->prev = voice->prev;
+    }
+    else
+    {
+        list->tail = voice->prev;
+    }
+    voice->prev = NULL;
+    voice->next = NULL;
+    voice->list = NULL;
+}
 
-    /*
-     * some hard voice
-     */
-    setting = &channelSettings[3];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.118110;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 32767;
-    setting->op_prop[2].d2l = 1.000000;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.094488;
-    setting->op_prop[2].mul = 3.250000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 1460;
-    setting->op_prop[3].d2l = 0.307086;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.999998;
-    setting->op_prop[3].mul = 0.750000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+static void FmSynth_VoiceMove(struct synthVoice_s *voice, struct fmVoiceList_s *list)
+{
+    FmSynth_VoiceListRemove(voice);
+    FmSynth_VoiceListAdd(list, voice);
+}
 
-    /*
-     * bassy base
-     */
-    setting = &channelSettings[4];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.999998;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 1;
-    setting->op_prop[0].d2l = 0.999998;
-    setting->op_prop[0].d2r = 3050;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 1.000000;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 1345;
-    setting->op_prop[1].d2l = 0.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.251968;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 32767;
-    setting->op_prop[2].d2l = 1.000000;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.039370;
-    setting->op_prop[2].mul = 1.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 115;
-    setting->op_prop[3].d2l = 0.622046;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.094488;
-    setting->op_prop[3].mul = 0.500000;
-    setting->op_prop[3].vel_to_tl = 0.141732;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+#define FM_PATCH_MONO   0x01
+#define FM_PATCH_LEGATO 0x02
 
-    /*
-     * organ
-     */
-    setting = &channelSettings[5];
-    setting->algo = 7;
-    setting->fmFeedback = 0.267716;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.881888;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 135;
-    setting->op_prop[1].d2l = 0.448818;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.653542;
-    setting->op_prop[1].mul = 3.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 14;
-    setting->op_prop[2].d2l = 0.267716;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.401574;
-    setting->op_prop[2].mul = 8.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 5;
-    setting->op_prop[3].d2l = 0.496062;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.236220;
-    setting->op_prop[3].mul = 4.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+/*
+ * header of a bank file, followed by patchCnt patches
+ */
+struct fm_bank_hdr_s
+{
+    char magic[4]; /* "FMBK" */
+    uint16_t version;
+    uint16_t patchSize; /* sizeof(struct fm_patch_s) */
+    uint32_t patchCnt;
+};
 
-    /*
-     * some bass
-     */
-    setting = &channelSettings[6];
-
-    setting->algo = 3;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.047244;
-    setting->op_prop[1].mul = 0.500000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 427;
-    setting->op_prop[2].d2l = 0.000000;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.196850;
-    setting->op_prop[2].mul = 1.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 50;
-    setting->op_prop[3].d2l = 0.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.062992;
-    setting->op_prop[3].mul = 2.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+#define FM_BANK_VERSION 1
 
-    /*
-     * schnatter bass
-     */
-    setting = &channelSettings[7];
-
-    setting->algo = 2;
-    setting->fmFeedback = 0.055118;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 363;
-    setting->op_prop[0].d2l = 0.614172;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.937006;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 204;
-    setting->op_prop[1].d2l = 0.196850;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.314960;
-    setting->op_prop[1].mul = 2.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 90;
-    setting->op_prop[2].d2l = 0.543306;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.716534;
-    setting->op_prop[2].mul = 2.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 10;
-    setting->op_prop[3].d2l = 0.299212;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.724408;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+static uint8_t FmSynth_PatchLevel(float value)
+{
+    value = (value > 0.0f) ? value : 0.0f;
+    value = (value < 1.0f) ? value : 1.0f;
+    return value * 127.0f + 0.5f;
+}
 
-    /*
-     * harpischord?
-     */
-    setting = &channelSettings[8];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 1.000000;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.102362;
-    setting->op_prop[1].mul = 3.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 1239;
-    setting->op_prop[2].d2l = 0.385826;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.094488;
-    setting->op_prop[2].mul = 1.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 28;
-    setting->op_prop[3].d2l = 0.283464;
-    setting->op_prop[3].d2r = 4593;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.173228;
-    setting->op_prop[3].mul = 15.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+static uint16_t FmSynth_PatchRate(uint32_t value)
+{
+    return (value < UINT16_MAX) ? value : UINT16_MAX;
+}
 
-    /*
-     * some harsh
-     */
-    setting = &channelSettings[9];
-
-    setting->algo = 3;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 2.800000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.236220;
-    setting->op_prop[1].mul = 2.200000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 32767;
-    setting->op_prop[2].d2l = 1.000000;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.173228;
-    setting->op_prop[2].mul = 2.400000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 393;
-    setting->op_prop[3].d2l = 0.307086;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.157480;
-    setting->op_prop[3].mul = 2.400000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-
-    /* string bass */
-    setting = &channelSettings[10];
-
-    setting->algo = 3;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 0.500000;
-    setting->op_prop[0].vel_to_tl = 0.078740;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.385826;
-    setting->op_prop[1].mul = 0.500000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 334;
-    setting->op_prop[2].d2l = 0.251968;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.330708;
-    setting->op_prop[2].mul = 1.010000;
-    setting->op_prop[2].vel_to_tl = 0.803148;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 27818;
-    setting->op_prop[3].d2l = 0.181102;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.700786;
-    setting->op_prop[3].mul = 0.500000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
+static void FmSynth_PatchPack(struct fm_patch_s *patch, const struct channelSettingParam_s *setting)
+{
+    memset(patch, 0, sizeof(*patch));
 
+    patch->algo = setting->algo;
+    patch->feedback = FmSynth_PatchLevel(setting->fmFeedback);
+    patch->flags = (setting->mono ? FM_PATCH_MONO : 0) | (setting->legato ? FM_PATCH_LEGATO : 0);
 
-    /*
-     * kick bass
-     */
-    setting = &channelSettings[11];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 2.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.078740;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 46;
-    setting->op_prop[2].d2l = 0.078740;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.094488;
-    setting->op_prop[2].mul = 11.000000;
-    setting->op_prop[2].vel_to_tl = 0.425196;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 32767;
-    setting->op_prop[3].d2l = 1.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.000000;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-
-    /* wood bass */
-    setting = &channelSettings[12];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 2.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.133858;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 46;
-    setting->op_prop[2].d2l = 0.078740;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.236220;
-    setting->op_prop[2].mul = 3.000000;
-    setting->op_prop[2].vel_to_tl = 0.425196;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 32767;
-    setting->op_prop[3].d2l = 1.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.000000;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-
-    /* saw bass */
-    setting = &channelSettings[13];
-
-
-    setting->algo = 5;
-    setting->fmFeedback = 0.503936;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.251968;
-    setting->op_prop[1].mul = 1.010000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 546;
-    setting->op_prop[2].d2l = 0.000000;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.330708;
-    setting->op_prop[2].mul = 2.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 308;
-    setting->op_prop[3].d2l = 0.251968;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.141732;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-
-    /* plug sound */
-    setting = &channelSettings[14];
-
-    setting->algo = 2;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 1;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 0.999998;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 76;
-    setting->op_prop[1].d2l = 0.267716;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.212598;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 1;
-    setting->op_prop[2].d1r = 36;
-    setting->op_prop[2].d2l = 0.393700;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.110236;
-    setting->op_prop[2].mul = 4.000000;
-    setting->op_prop[2].vel_to_tl = 0.527558;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 1;
-    setting->op_prop[3].d1r = 32767;
-    setting->op_prop[3].d2l = 1.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.055118;
-    setting->op_prop[3].mul = 1.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-
-    /* fady stuff */
-    setting = &channelSettings[15];
-
-    setting->algo = 0;
-    setting->fmFeedback = 0.000000;
-    setting->op_prop[0].ar = 70;
-    setting->op_prop[0].d1r = 32767;
-    setting->op_prop[0].d2l = 1.000000;
-    setting->op_prop[0].d2r = 32767;
-    setting->op_prop[0].rr = 1;
-    setting->op_prop[0].rs = 50;
-    setting->op_prop[0].tl = 1.000000;
-    setting->op_prop[0].mul = 1.000000;
-    setting->op_prop[0].vel_to_tl = 0.000000;
-    setting->op_prop[0].am = 0.000000;
-    setting->op_prop[0].mw = 0.000000;
-    setting->op_prop[0].vel = 0.000000;
-    setting->op_prop[1].ar = 1;
-    setting->op_prop[1].d1r = 32767;
-    setting->op_prop[1].d2l = 1.000000;
-    setting->op_prop[1].d2r = 32767;
-    setting->op_prop[1].rr = 1;
-    setting->op_prop[1].rs = 50;
-    setting->op_prop[1].tl = 0.023622;
-    setting->op_prop[1].mul = 1.000000;
-    setting->op_prop[1].vel_to_tl = 0.000000;
-    setting->op_prop[1].am = 0.000000;
-    setting->op_prop[1].mw = 0.000000;
-    setting->op_prop[1].vel = 0.000000;
-    setting->op_prop[2].ar = 2198;
-    setting->op_prop[2].d1r = 32767;
-    setting->op_prop[2].d2l = 1.000000;
-    setting->op_prop[2].d2r = 32767;
-    setting->op_prop[2].rr = 1;
-    setting->op_prop[2].rs = 50;
-    setting->op_prop[2].tl = 0.496062;
-    setting->op_prop[2].mul = 2.000000;
-    setting->op_prop[2].vel_to_tl = 0.000000;
-    setting->op_prop[2].am = 0.000000;
-    setting->op_prop[2].mw = 0.000000;
-    setting->op_prop[2].vel = 0.000000;
-    setting->op_prop[3].ar = 30191;
-    setting->op_prop[3].d1r = 32767;
-    setting->op_prop[3].d2l = 1.000000;
-    setting->op_prop[3].d2r = 32767;
-    setting->op_prop[3].rr = 1;
-    setting->op_prop[3].rs = 50;
-    setting->op_prop[3].tl = 0.000000;
-    setting->op_prop[3].mul = 4.000000;
-    setting->op_prop[3].vel_to_tl = 0.000000;
-    setting->op_prop[3].am = 0.000000;
-    setting->op_prop[3].mw = 0.000000;
-    setting->op_prop[3].vel = 0.000000;
-}
-
-static void FmSynth_ProcessOperator(struct synthTone_s *osc)
-{
-    float pitch = osc->pitchCalc;
-
-    int32_t phaseShift = 100000 * (int32_t)((float)(osc->in) * (float)multiplierPitchToAddValue);
-    osc->in = 0;
-
-    int32_t add = (int32_t)(pitch * multiplierPitchToAddValue);
-    osc->pos += add ;
+    patch->lfo.speed = FmSynth_PatchRate(setting->props.lfo_speed * 100.0f + 0.5f);
+    patch->lfo.fms = FmSynth_PatchRate(setting->props.fms * 100.0f + 0.5f);
+    patch->lfo.fmsmw = FmSynth_PatchRate(setting->props.fmsmw * 100.0f + 0.5f);
+    patch->lfo.enable = setting->props.lfo_enable > 0.0f;
+    patch->lfo.ams = FmSynth_PatchLevel(setting->props.ams);
 
-#ifdef FM_PHASESHIFT_ENABLED
-    osc->pos += phaseShift;
-    osc->sine_preoout = SineNormU32(osc->pos) ;
-#else
-    osc->sine_preoout = SineNormU32(osc->pos + phaseShift) ;
-#endif
-    osc->lvl_env += osc->lvl_add;
+    for (int i = 0; i < 4; i++)
+    {
+        const struct op_properties_s *op_prop = &setting->op_prop[i];
+        struct fm_patch_op_s *op = &patch->op[i];
+
+        op->ar = FmSynth_PatchRate(op_prop->ar);
+        op->d1r = FmSynth_PatchRate(op_prop->d1r);
+        op->d2r = FmSynth_PatchRate(op_prop->d2r);
+        op->rr = FmSynth_PatchRate(op_prop->rr);
+        op->mul = FmSynth_PatchRate(op_prop->mul * 100.0f + 0.5f);
+        op->rs = (op_prop->rs < UINT8_MAX) ? op_prop->rs : UINT8_MAX;
+        op->d2l = FmSynth_PatchLevel(op_prop->d2l);
+        op->tl = FmSynth_PatchLevel(op_prop->tl);
+        op->vel_to_tl = FmSynth_PatchLevel(op_prop->vel_to_tl);
+        op->am = FmSynth_PatchLevel(op_prop->am);
+        op->mw = FmSynth_PatchLevel(op_prop->mw);
+        op->vel = FmSynth_PatchLevel(op_prop->vel);
+        op->ks = op_prop->ks;
+        op->ssgeg = op_prop->ssgeg;
+    }
 }
 
-static void FmSynth_EnvStateProcess(struct synthTone_s *osc)
+/*
+ * the note stack of the channel is not touched, so this can be used while notes are playing
+ */
+static void FmSynth_PatchUnpack(struct channelSettingParam_s *setting, const struct fm_patch_s *patch)
 {
-    osc->stateLen --;
-    if (osc->stateLen <= 0)
+    const float lvl = 1.0f / 127.0f;
+
+    setting->algo = patch->algo;
+    setting->fmFeedback = patch->feedback * lvl;
+    setting->mono = (patch->flags & FM_PATCH_MONO) != 0;
+    setting->legato = (patch->flags & FM_PATCH_LEGATO) != 0;
+
+    setting->props.lfo_speed = patch->lfo.speed / 100.0f;
+    setting->props.fms = patch->lfo.fms / 100.0f;
+    setting->props.fmsmw = patch->lfo.fmsmw / 100.0f;
+    setting->props.lfo_enable = patch->lfo.enable ? 1.0f : 0.0f;
+    setting->props.ams = patch->lfo.ams * lvl;
+
+    for (int i = 0; i < 4; i++)
     {
-        if (osc->state != ENV_OFF)
-        {
-            osc->state++;
-            FmSynth_ToneEnvUpdate(osc);
-        }
+        const struct fm_patch_op_s *op = &patch->op[i];
+        struct op_properties_s *op_prop = &setting->op_prop[i];
+
+        op_prop->ar = op->ar;
+        op_prop->d1r = op->d1r;
+        op_prop->d2r = op->d2r;
+        op_prop->rr = op->rr;
+        op_prop->rs = op->rs;
+        op_prop->d2l = op->d2l * lvl;
+        op_prop->tl = op->tl * lvl;
+        op_prop->vel_to_tl = op->vel_to_tl * lvl;
+        op_prop->am = op->am * lvl;
+        op_prop->mw = op->mw * lvl;
+        op_prop->vel = op->vel * lvl;
+        op_prop->ks = op->ks;
+        op_prop->ssgeg = op->ssgeg;
+
+        op_prop->mul = op->mul / 100.0f;
+        op_prop->mul_coarse = (op->mul < 100) ? 0.5f : (float)(op->mul / 100);
+        op_prop->mul_fine = op_prop->mul - op_prop->mul_coarse;
     }
 }
 
-static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
+/*
+ * preset bank, one patch per MIDI channel
+ * lfo: speed * 100, fms * 100, fmsmw * 100, enable, ams
+ * operator: ar, d1r, d2r, rr, mul * 100, rs, d2l, tl, vel_to_tl, am, mw, vel, ks, ssgeg, reserved
+ */
+static const struct fm_patch_s fmBankDefault[MIDI_CH_CNT] =
 {
-    voice->out = 0.0f;
-
-    voice->op[OP1].in += (voice->settings->fmFeedback * voice->op[OP1].out);
-
-    switch (voice->settings->algo)
+    /* 0 */
     {
-    /*
-     * alg 1:
-     * 1->2
-     * 2->3
-     * 3->4
-     * 4->O
-     * eg. Distortion guitar, "high hat chopper" (?) bass
-    */
-    case 0:
-        voice->out += voice->op[OP4].out;
-        voice->op[OP4].in += voice->op[OP3].out;
-        voice->op[OP3].in += voice->op[OP2].out;
-        voice->op[OP2].in += voice->op[OP1].out;
-        break;
-    /*
-    * alg 2:
-    * 1->3
-    * 2->3
-    * 3->4
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 1, 32767, 1, 250, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 1, 32767, 1, 350, 50, 44, 41, 78, 0, 0, 0, 0, 0, 0 },
+            { 1, 1, 32767, 1, 1100, 50, 51, 6, 127, 0, 0, 0, 0, 0, 0 },
+            { 1, 1, 32767, 1, 100, 50, 127, 0, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 1 */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 1, 32767, 1023, 250, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 1, 32767, 1023, 350, 50, 44, 41, 78, 0, 0, 0, 0, 0, 0 },
+            { 1, 1, 32767, 1023, 1100, 50, 51, 6, 127, 0, 0, 0, 0, 0, 0 },
+            { 1, 1, 32767, 1, 100, 50, 127, 0, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 2: like a guitar */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 147, 2386, 1, 100, 50, 81, 45, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 1239, 32767, 1, 125, 50, 127, 23, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 26, 32767, 1, 63, 50, 0, 37, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 3: some hard voice */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 15, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 325, 50, 127, 12, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 1460, 32767, 1, 75, 50, 39, 127, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 4: bassy base */
+    {
+        0, 127, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 1, 3050, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 1345, 32767, 1, 100, 50, 0, 32, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 5, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 115, 32767, 1, 50, 50, 79, 12, 18, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 5: organ */
+    {
+        7, 34, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 112, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 135, 32767, 1, 300, 50, 57, 83, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 14, 32767, 1, 800, 50, 34, 51, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 5, 32767, 1, 400, 50, 63, 30, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 6: some bass */
+    {
+        3, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 50, 50, 127, 6, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 427, 32767, 1, 100, 50, 0, 25, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 50, 32767, 1, 200, 50, 0, 8, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 7: schnatter bass */
+    {
+        2, 7, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 363, 32767, 1, 100, 50, 78, 119, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 204, 32767, 1, 200, 50, 25, 40, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 90, 32767, 1, 200, 50, 69, 91, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 10, 32767, 1, 100, 50, 38, 92, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 8: harpischord? */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 300, 50, 127, 13, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 1239, 32767, 1, 100, 50, 49, 12, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 28, 4593, 1, 1500, 50, 36, 22, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 9: some harsh */
+    {
+        3, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 280, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 220, 50, 127, 30, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 240, 50, 127, 22, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 393, 32767, 1, 240, 50, 39, 20, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 10 */
+    {
+        3, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 50, 50, 127, 127, 10, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 50, 50, 127, 49, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 334, 32767, 1, 101, 50, 32, 42, 102, 0, 0, 0, 0, 0, 0 },
+            { 1, 27818, 32767, 1, 50, 50, 23, 89, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 11: kick bass */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 200, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 10, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 46, 32767, 1, 1100, 50, 10, 12, 54, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 0, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 12 */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 200, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 17, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 46, 32767, 1, 300, 50, 10, 30, 54, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 0, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 13 */
+    {
+        5, 64, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 101, 50, 127, 32, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 546, 32767, 1, 200, 50, 0, 42, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 308, 32767, 1, 100, 50, 32, 18, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 14 */
+    {
+        2, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 1, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 76, 32767, 1, 100, 50, 34, 27, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 36, 32767, 1, 400, 50, 50, 14, 67, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 7, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+    /* 15 */
+    {
+        0, 0, 0, 0,
+        { 500, 0, 100, 0, 0 },
+        {
+            { 70, 32767, 32767, 1, 100, 50, 127, 127, 0, 0, 0, 0, 0, 0, 0 },
+            { 1, 32767, 32767, 1, 100, 50, 127, 3, 0, 0, 0, 0, 0, 0, 0 },
+            { 2198, 32767, 32767, 1, 200, 50, 127, 63, 0, 0, 0, 0, 0, 0, 0 },
+            { 30191, 32767, 32767, 1, 400, 50, 127, 0, 0, 0, 0, 0, 0, 0, 0 },
+        }
+    },
+};
+
+FmEngine::FmEngine()
+{
+    fmVoice = NULL;
+    fmVoiceCnt = 0;
+
+    fmVoiceFree.head = fmVoiceFree.tail = NULL;
+    fmVoiceHeld.head = fmVoiceHeld.tail = NULL;
+    fmVoiceReleased.head = fmVoiceReleased.tail = NULL;
+
+    multiplierPitchToAddValue = 0;
+#ifdef FM_FIXED_POINT_ENABLED
+    phaseModQ15 = 0;
+#endif
+    processGain = 1.0f;
+
+    blockLen = 1;
+    modulationDepth = 0.0f;
+#ifdef PRESSURE_SENSOR_ENABLED
+    pressureValue = 0.0f;
+    pressureValueFilt = 0.0f;
+#endif
+
+    sample_rate = 0;
+
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        FmSynth_InitChannelSettings(&channelSettings[ch]);
+        pitchBendValue[ch] = 0.0f;
+        chBendVar[ch] = 0.0f;
+        chBendMultiplier[ch] = 1.0f;
+        chPitchMultiplierStart[ch] = 1.0f;
+        chPitchMultiplierEnd[ch] = 1.0f;
+        chLfoPhase[ch] = 0;
+        chLfoPitch[ch] = 0.0f;
+        chLfoAmStart[ch] = 0.0f;
+        chLfoAmEnd[ch] = 0.0f;
+    }
+    currentChSetting = &channelSettings[0];
+    selectedOp = OP4;
+
+    initChannelSetting = false;
+    initChannelSettingCnt = 0;
+
+    FmSynth_InitOpProps(&op_props_silent);
+
+    fmBank = fmBankDefault;
+    fmBankCnt = MIDI_CH_CNT;
+}
+
+uint32_t FmEngine::VoiceMemSize(uint32_t voice_cnt)
+{
+    return sizeof(struct synthVoice_s) * voice_cnt;
+}
+
+void FmEngine::Init(float sample_rate_in)
+{
+    Init(sample_rate_in, NULL, 0);
+}
+
+/*
+ * voice_mem must provide VoiceMemSize(voice_cnt) bytes
+ * it will be used by the engine until the next call of Init
+ * without voice memory the engine stays silent (only FmSynth_Init has default voices)
+ */
+void FmEngine::Init(float sample_rate_in, void *voice_mem, uint32_t voice_cnt)
+{
+#if !defined(GLOBAL_SINE) || defined(FM_FIXED_POINT_ENABLED)
+    Sine_Init();
+#endif
+
+    sample_rate = sample_rate_in;
+    multiplierPitchToAddValue = ((float)(1ULL << 32ULL) / ((float)sample_rate));
+#ifdef FM_FIXED_POINT_ENABLED
+    phaseModQ15 = 100000.0f * multiplierPitchToAddValue / 32768.0f;
+#endif
+
+    FmSynth_InitOpProps(&op_props_silent);
+    op_props_silent.tl = 0.0f;
+    op_props_silent.d1r = 1;
+    op_props_silent.d2r = 1;
+
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        FmSynth_InitChannelSettings(&channelSettings[ch]);
+        pitchBendValue[ch] = 0.0f;
+        chBendVar[ch] = 0.0f;
+        chBendMultiplier[ch] = 1.0f;
+        chPitchMultiplierStart[ch] = 1.0f;
+        chPitchMultiplierEnd[ch] = 1.0f;
+        chLfoPhase[ch] = 0;
+        chLfoPitch[ch] = 0.0f;
+        chLfoAmStart[ch] = 0.0f;
+        chLfoAmEnd[ch] = 0.0f;
+    }
+
+    if ((voice_mem == NULL) || (voice_cnt == 0))
+    {
+        Status_LogMessage("no memory for fm voices!\n");
+        voice_mem = NULL;
+        voice_cnt = 0;
+    }
+
+    fmVoice = (struct synthVoice_s *)voice_mem;
+    fmVoiceCnt = voice_cnt;
+
+    fmVoiceFree.head = fmVoiceFree.tail = NULL;
+    fmVoiceHeld.head = fmVoiceHeld.tail = NULL;
+    fmVoiceReleased.head = fmVoiceReleased.tail = NULL;
+
+    for (uint32_t j = 0; j < fmVoiceCnt; j++)
+    {
+        InitVoice(&fmVoice[j]);
+        FmSynth_VoiceListAdd(&fmVoiceFree, &fmVoice[j]);
+    }
+
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        FmSynth_PatchUnpack(&channelSettings[ch], &fmBankDefault[ch]);
+    }
+
+}
+
+/*
+ * advances the envelope state of all operators by len samples
+ * returns false when all operators have become quiet
+ */
+static bool FmSynth_EnvStateProcess(struct synthVoice_s *voice, uint32_t len)
+{
+    bool sounding = false;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (voice->state[i] != ENV_OFF)
+        {
+            voice->stateLen[i] -= len;
+            if (voice->stateLen[i] <= 0)
+            {
+                FmSynth_EgNext(voice, i);
+                FmSynth_ToneEnvUpdate(voice, i);
+            }
+        }
+        sounding |= voice->state[i] != ENV_OFF;
+    }
+
+    return sounding;
+}
+
+/*
+ * routes the operator outputs of the current sample to the operator inputs of the next sample
+ * returns the output of the voice
+ */
+static inline fm_sample_t FmSynth_FeedbackMul(fm_sample_t feedback, fm_sample_t out)
+{
+#ifdef FM_FIXED_POINT_ENABLED
+    return (feedback * out) >> 15;
+#else
+    return feedback * out;
+#endif
+}
+
+static inline fm_sample_t FmSynth_AlgMixProcess(fm_sample_t *in, const fm_sample_t *out, int algo, fm_sample_t feedback)
+{
+    fm_sample_t voiceOut = 0;
+
+    in[OP1] += FmSynth_FeedbackMul(feedback, out[OP1]);
+
+    switch (algo)
+    {
+    /*
+     * alg 1:
+     * 1->2
+     * 2->3
+     * 3->4
+     * 4->O
+     * eg. Distortion guitar, "high hat chopper" (?) bass
+    */
+    case 0:
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP3] += out[OP2];
+        in[OP2] += out[OP1];
+        break;
+    /*
+    * alg 2:
+    * 1->3
+    * 2->3
+    * 3->4
     * 4->O
     * eg. Harp, PSG (programmable sound generator) sound
     */
     case 1:
-        voice->out += voice->op[OP4].out;
-        voice->op[OP4].in += voice->op[OP3].out;
-        voice->op[OP3].in += voice->op[OP2].out;
-        voice->op[OP3].in += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP3] += out[OP2];
+        in[OP3] += out[OP1];
         break;
     /*
     * alg 3:
@@ -1373,10 +1161,10 @@ static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
     * eg. Bass, electric guitar, brass, piano, woods
     */
     case 2:
-        voice->out += voice->op[OP4].out;
-        voice->op[OP4].in += voice->op[OP3].out;
-        voice->op[OP4].in += voice->op[OP2].out;
-        voice->op[OP3].in += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP4] += out[OP2];
+        in[OP3] += out[OP1];
         break;
     /*
     * alg 4:
@@ -1387,10 +1175,10 @@ static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
     * eg. Strings, folk guitar, chimes
     */
     case 3:
-        voice->out += voice->op[OP4].out;
-        voice->op[OP4].in += voice->op[OP3].out;
-        voice->op[OP4].in += voice->op[OP2].out;
-        voice->op[OP2].in += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP4] += out[OP2];
+        in[OP2] += out[OP1];
         break;
     /*
     * alg 5:
@@ -1401,10 +1189,10 @@ static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
     * eg. Flute, bells, chorus, bass drum, snare drum, tom-tom
     */
     case 4:
-        voice->out += voice->op[OP4].out;
-        voice->op[OP4].in += voice->op[OP3].out;
-        voice->out += voice->op[OP2].out;
-        voice->op[OP2].in += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        voiceOut += out[OP2];
+        in[OP2] += out[OP1];
         break;
     /*
     * alg 6:
@@ -1414,12 +1202,12 @@ static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
     * eg. Brass, organ
     */
     case 5:
-        voice->out += voice->op[OP4].out;
-        voice->out += voice->op[OP3].out;
-        voice->out += voice->op[OP2].out;
-        voice->op[OP4].in += voice->op[OP1].out;
-        voice->op[OP3].in += voice->op[OP1].out;
-        voice->op[OP2].in += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        voiceOut += out[OP3];
+        voiceOut += out[OP2];
+        in[OP4] += out[OP1];
+        in[OP3] += out[OP1];
+        in[OP2] += out[OP1];
         break;
     /*
      * alg 7:
@@ -1430,10 +1218,10 @@ static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
     * eg. Xylophone, tom-tom, organ, vibraphone, snare drum, base drum
      */
     case 6:
-        voice->out += voice->op[OP4].out;
-        voice->out += voice->op[OP3].out;
-        voice->out += voice->op[OP2].out;
-        voice->op[OP2].in += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        voiceOut += out[OP3];
+        voiceOut += out[OP2];
+        in[OP2] += out[OP1];
         break;
     /*
     * alg 8:
@@ -1441,74 +1229,425 @@ static void FmSynth_AlgMixProcess(float *out, struct synthVoice_s *voice)
     * eg. Pipe organ
      */
     case 7:
-        voice->out += voice->op[OP4].out;
-        voice->out += voice->op[OP3].out;
-        voice->out += voice->op[OP2].out;
-        voice->out += voice->op[OP1].out;
+        voiceOut += out[OP4];
+        voiceOut += out[OP3];
+        voiceOut += out[OP2];
+        voiceOut += out[OP1];
         break;
     }
 
-    *out += voice->out;
+    return voiceOut;
+}
+
+/*
+ * algorithm specific version of FmSynth_AlgMixProcess
+ * the algorithm is known at compile time which removes the switch from the sample loop
+ */
+template<int ALG>
+static inline fm_sample_t FmSynth_AlgMix(fm_sample_t *in, const fm_sample_t *out, fm_sample_t feedback)
+{
+    fm_sample_t voiceOut = 0;
 
-    voice->outSlow = fmax(fabs(voice->out), voice->outSlow);
+    in[OP1] += FmSynth_FeedbackMul(feedback, out[OP1]);
+
+    switch (ALG)
+    {
+    case 0:
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP3] += out[OP2];
+        in[OP2] += out[OP1];
+        break;
+    case 1:
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP3] += out[OP2];
+        in[OP3] += out[OP1];
+        break;
+    case 2:
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP4] += out[OP2];
+        in[OP3] += out[OP1];
+        break;
+    case 3:
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        in[OP4] += out[OP2];
+        in[OP2] += out[OP1];
+        break;
+    case 4:
+        voiceOut += out[OP4];
+        in[OP4] += out[OP3];
+        voiceOut += out[OP2];
+        in[OP2] += out[OP1];
+        break;
+    case 5:
+        voiceOut += out[OP4];
+        voiceOut += out[OP3];
+        voiceOut += out[OP2];
+        in[OP4] += out[OP1];
+        in[OP3] += out[OP1];
+        in[OP2] += out[OP1];
+        break;
+    case 6:
+        voiceOut += out[OP4];
+        voiceOut += out[OP3];
+        voiceOut += out[OP2];
+        in[OP2] += out[OP1];
+        break;
+    case 7:
+        voiceOut += out[OP4];
+        voiceOut += out[OP3];
+        voiceOut += out[OP2];
+        voiceOut += out[OP1];
+        break;
+    }
+
+    return voiceOut;
 }
 
-inline
-float FmSynth_GetModulationPitchMultiplier(void)
+/*
+ * operator state used while rendering a chunk
+ * kept as local copy to allow the compiler to hold it in registers
+ */
+struct fmOpState_s
+{
+    uint32_t pos[4];
+    uint32_t add[4];
+    fm_sample_t in[4];
+    fm_sample_t out[4];
+    uint32_t eg_att[4];
+    uint32_t eg_add[4];
+    uint32_t eg_mul[4];
+    uint32_t eg_xor[4]; /* ssg-eg inversion */
+    uint32_t eg_ofs[4];
+    fm_sample_t gain[4];
+    fm_sample_t gainStep[4];
+    fm_phase_mod_t phaseMod;
+};
+
+static inline void FmSynth_ProcessOperator(int i, struct fmOpState_s *op)
 {
-    float modSpeed = modulationSpeed;
-    return modulationDepth * modulationPitch * (SineNorm((modSpeed * ((float)milliCnt) / 1000.0f)));
+#ifdef FM_FIXED_POINT_ENABLED
+    uint32_t phaseShift = (uint32_t)op->in[i] * op->phaseMod;
+#else
+    int32_t phaseShift = 100000 * (int32_t)((float)(op->in[i]) * (float)op->phaseMod);
+#endif
+    op->in[i] = 0;
+
+    op->pos[i] += op->add[i];
+
+    uint32_t att = op->eg_att[i];
+    att = att + op->eg_add[i] - (uint32_t)(((uint64_t)att * op->eg_mul[i]) >> 32);
+    op->eg_att[i] = att;
+
+    uint32_t idx = att >> FM_EG_FRAC;
+    idx = (idx < FM_EG_MSK) ? idx : FM_EG_MSK;
+    idx = ((idx ^ op->eg_xor[i]) + op->eg_ofs[i]) & FM_EG_MSK;
+
+#ifdef FM_PHASESHIFT_ENABLED
+    op->pos[i] += phaseShift;
+    const uint32_t pos = op->pos[i];
+#else
+    const uint32_t pos = op->pos[i] + phaseShift;
+#endif
+
+#ifdef FM_FIXED_POINT_ENABLED
+    const int32_t lvl = fmEgPow2[idx & 63] >> (idx >> 6);
+    op->out[i] = (((SineQ15U32(pos) * lvl) >> 15) * op->gain[i]) >> 15;
+#else
+    const float lvl = (float)(fmEgPow2[idx & 63] >> (idx >> 6));
+    op->out[i] = SineNormU32(pos) * lvl * op->gain[i];
+#endif
 }
 
-void FmSynth_Process(const float *in __attribute__((unused)), float *out, int bufLen)
+#define FM_ALG_REF  (-1) /* uses the switch in FmSynth_AlgMixProcess */
+
+/*
+ * renders len samples of a voice without any envelope state change in between
+ */
+template<int ALG>
+static void FmSynth_ProcessVoiceChunk(struct synthVoice_s *voice, fm_sample_t *out, uint32_t len, fm_phase_mod_t phaseMod)
 {
-    milliCnt += (bufLen * 1000) / sample_rate;
+    struct fmOpState_s op;
 
-    float pitchVar = pitchBendValue + FmSynth_GetModulationPitchMultiplier();
-    pitchMultiplier = pow(2.0f, pitchVar / 12.0f);
+    op.phaseMod = phaseMod;
 
-    for (int n = 0; n < bufLen; n++)
+    const int algo = voice->settings->algo;
+    const fm_sample_t feedback = voice->feedback;
+
+    for (int i = 0; i < 4; i++)
     {
-#ifdef PRESSURE_SENSOR_ENABLED
-        pressureValueFilt = pressureValueFilt * 0.99f + pressureValue * 0.01f;
-#endif
+        op.pos[i] = voice->pos[i];
+        op.add[i] = voice->add[i];
+        op.in[i] = voice->in[i];
+        op.out[i] = voice->out[i];
+        op.eg_att[i] = voice->eg_att[i];
+        op.eg_add[i] = voice->eg_add[i];
+        op.eg_mul[i] = voice->eg_mul[i];
+        op.eg_xor[i] = voice->ssgInv[i] ? FM_EG_MSK : 0; /* (0x200 - idx) & 0x3FF */
+        op.eg_ofs[i] = voice->ssgInv[i] ? 0x201 : 0;
+        op.gain[i] = voice->gain[i];
+        op.gainStep[i] = voice->gainStep[i];
+    }
 
-        float sample = 0.0f;
+    int32_t addStep[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        addStep[i] = voice->addStep[i];
+    }
 
-        for (int j = 0; j < FM_VOICE_CNT; j++)
+    for (uint32_t n = 0; n < len; n++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            op.add[i] += addStep[i];
+        }
+        for (int i = 0; i < 4; i++)
         {
-            struct synthVoice_s *voice = &fmVoice[j];
+            op.gain[i] += op.gainStep[i];
+        }
 
-            for (int i = 0; i < 4; i++)
-            {
-                struct synthTone_s *osc = &voice->op[i];
-                osc->pitchCalc = osc->op_prop->mul * osc->pitch * pitchMultiplier;
-                FmSynth_ProcessOperator(osc);
-                {
-                    osc->out = osc->sine_preoout * osc->op_prop->tl * osc->lvl_env * osc->vel;
-#ifdef PRESSURE_SENSOR_ENABLED
-                    osc->out *= pressureValueFilt;
+        /* written out to keep the operator state in registers */
+        FmSynth_ProcessOperator(OP4, &op);
+        FmSynth_ProcessOperator(OP3, &op);
+        FmSynth_ProcessOperator(OP2, &op);
+        FmSynth_ProcessOperator(OP1, &op);
+
+        const fm_sample_t voiceOut = (ALG == FM_ALG_REF) ? FmSynth_AlgMixProcess(op.in, op.out, algo, feedback) : FmSynth_AlgMix<ALG>(op.in, op.out, feedback);
+
+        out[n] += voiceOut;
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        voice->pos[i] = op.pos[i];
+        voice->add[i] = op.add[i];
+        voice->in[i] = op.in[i];
+        voice->out[i] = op.out[i];
+        voice->eg_att[i] = op.eg_att[i];
+        voice->gain[i] = op.gain[i];
+    }
+}
+
+/*
+ * 2^x for the small values of the lfo pitch modulation
+ * the error is below 0.1 cent for |x| < 0.25 (3 semitones)
+ */
+static inline float FmSynth_Exp2Small(float x)
+{
+    const float y = x * 0.69314718f;
+    return 1.0f + y * (1.0f + y * (0.5f + y * (1.0f / 6.0f)));
+}
+
+/*
+ * advances the lfo of all channels by one block
+ * - pitch: fms when the lfo is enabled and fmsmw scaled by the mod wheel
+ * - amplitude: ams when the lfo is enabled, the operators are selected by am
+ * the values at the start and the end of the block are used to interpolate over the block
+ */
+void FmEngine::LfoUpdate(int bufLen)
+{
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        const struct custom_properties_s *props = &channelSettings[ch].props;
+        const bool lfoOn = props->lfo_enable > 0.0f;
+
+        chLfoPhase[ch] += (uint32_t)(props->lfo_speed * (float)bufLen * multiplierPitchToAddValue);
+
+        const float lfo = SineNorm(chLfoPhase[ch]);
+
+        chLfoPitch[ch] = lfo * ((lfoOn ? props->fms : 0.0f) + props->fmsmw * modulationDepth);
+
+        chLfoAmStart[ch] = chLfoAmEnd[ch];
+        chLfoAmEnd[ch] = lfoOn ? (props->ams * 0.5f * (1.0f + lfo)) : 0.0f;
+    }
+}
+
+/*
+ * updates the pitch multiplier of all channels (pitchbend and lfo)
+ * pow is only called when the pitchbend has been changed since the last block
+ * the voices ramp their phase increment from the start to the end value over the block
+ */
+void FmEngine::ChannelPitchUpdate(void)
+{
+    for (int ch = 0; ch < MIDI_CH_CNT; ch++)
+    {
+        if (pitchBendValue[ch] != chBendVar[ch])
+        {
+            chBendVar[ch] = pitchBendValue[ch];
+            chBendMultiplier[ch] = pow(2.0f, chBendVar[ch] / 12.0f);
+        }
+        chPitchMultiplierStart[ch] = chPitchMultiplierEnd[ch];
+        chPitchMultiplierEnd[ch] = chBendMultiplier[ch] * FmSynth_Exp2Small(chLfoPitch[ch] * (1.0f / 12.0f));
+    }
+}
+
+/*
+ * forces recalculation of the phase increments (required when mul has been changed)
+ */
+void FmEngine::PitchInvalidate(void)
+{
+    for (uint32_t j = 0; j < fmVoiceCnt; j++)
+    {
+        fmVoice[j].pitchMultiplier = 0.0f;
+    }
+}
+
+typedef void(*fmVoiceChunkFn)(struct synthVoice_s *voice, fm_sample_t *out, uint32_t len, fm_phase_mod_t phaseMod);
+
+static const fmVoiceChunkFn fmVoiceChunkAlg[8] =
+{
+    FmSynth_ProcessVoiceChunk<0>,
+    FmSynth_ProcessVoiceChunk<1>,
+    FmSynth_ProcessVoiceChunk<2>,
+    FmSynth_ProcessVoiceChunk<3>,
+    FmSynth_ProcessVoiceChunk<4>,
+    FmSynth_ProcessVoiceChunk<5>,
+    FmSynth_ProcessVoiceChunk<6>,
+    FmSynth_ProcessVoiceChunk<7>,
+};
+
+/*
+ * renders len samples of a voice, pos is the position of out within the block
+ * the block is split at the envelope state changes
+ *
+ * FM_ALG_REFERENCE can be defined to use the generic switch based mixing
+ * (same output but slower)
+ */
+void FmEngine::ProcessVoice(struct synthVoice_s *voice, fm_sample_t *out, uint32_t pos, uint32_t len, float gain)
+{
+    const int ch = (voice->midiCh < MIDI_CH_CNT) ? voice->midiCh : 0;
+
+    /* pitch ramp, linear over the block like the amplitude modulation */
+    const float pmDiff = (chPitchMultiplierEnd[ch] - chPitchMultiplierStart[ch]) / (float)blockLen;
+    const float pmStart = chPitchMultiplierStart[ch] + pmDiff * (float)pos;
+    const float pmEnd = pmStart + pmDiff * (float)len;
+    uint32_t addEnd[4];
+    bool pitchChanged = (pmStart != voice->pitchMultiplier) || (pmEnd != pmStart);
+
+    if (pitchChanged)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            const float addScale = voice->op_prop[i]->mul * voice->pitch * multiplierPitchToAddValue;
+            voice->add[i] = (int32_t)(addScale * pmStart);
+            addEnd[i] = (int32_t)(addScale * pmEnd);
+            voice->addStep[i] = ((int32_t)(addEnd[i] - voice->add[i])) / (int32_t)len;
+        }
+        voice->pitchMultiplier = pmEnd;
+    }
+
+    /* lfo amplitude modulation, linear over the block */
+    const float amDiff = (chLfoAmEnd[ch] - chLfoAmStart[ch]) / (float)blockLen;
+    const float amStart = chLfoAmStart[ch] + amDiff * (float)pos;
+    const float amEnd = amStart + amDiff * (float)len;
+
+    for (int i = 0; i < 4; i++)
+    {
+        const float opGain = voice->op_prop[i]->tl * voice->vel[i] * gain * FM_OP_GAIN;
+        const float am = voice->op_prop[i]->am;
+        const float gainStart = opGain * (1.0f - am * amStart);
+        const float gainEnd = opGain * (1.0f - am * amEnd);
+
+        voice->gain[i] = gainStart;
+        voice->gainStep[i] = (gainEnd - gainStart) / (float)len;
+    }
+    voice->feedback = voice->settings->fmFeedback * FM_SAMPLE_ONE;
+
+#ifdef FM_FIXED_POINT_ENABLED
+    const fm_phase_mod_t phaseMod = phaseModQ15;
+#else
+    const fm_phase_mod_t phaseMod = multiplierPitchToAddValue;
 #endif
-                }
+    uint32_t n = 0;
 
-                FmSynth_EnvStateProcess(osc);
+    while (voice->active && (n < len))
+    {
+        uint32_t chunkLen = len - n;
+
+        for (int i = 0; i < 4; i++)
+        {
+            if ((voice->state[i] != ENV_OFF) && ((uint32_t)voice->stateLen[i] < chunkLen))
+            {
+                chunkLen = voice->stateLen[i];
             }
+        }
 
+#ifdef FM_ALG_REFERENCE
+        FmSynth_ProcessVoiceChunk<FM_ALG_REF>(voice, &out[n], chunkLen, phaseMod);
+#else
+        if ((voice->settings->algo >= 0) && (voice->settings->algo < 8))
+        {
+            fmVoiceChunkAlg[voice->settings->algo](voice, &out[n], chunkLen, phaseMod);
+        }
+        else
+        {
+            FmSynth_ProcessVoiceChunk<FM_ALG_REF>(voice, &out[n], chunkLen, phaseMod);
+        }
+#endif
+        n += chunkLen;
+
+        voice->active = FmSynth_EnvStateProcess(voice, chunkLen);
+    }
+
+    if (pitchChanged)
+    {
+        /* removes the rounding error of the ramp */
+        for (int i = 0; i < 4; i++)
+        {
+            voice->add[i] = addEnd[i];
+            voice->addStep[i] = 0;
+        }
+    }
+}
+
+/*
+ * renders the voices of a list and returns those which became quiet to the free list
+ */
+void FmEngine::ProcessVoiceList(struct fmVoiceList_s *list, fm_sample_t *out, uint32_t pos, uint32_t len, float gain)
+{
+    struct synthVoice_s *voice = list->head;
+
+    while (voice != NULL)
+    {
+        struct synthVoice_s *next = voice->next;
+
+        ProcessVoice(voice, out, pos, len, gain);
 
-            FmSynth_AlgMixProcess(&sample, voice);
+        if (!voice->active)
+        {
+            FmSynth_VoiceMove(voice, &fmVoiceFree);
         }
 
-        out[n] = sample / 8;
+        voice = next;
     }
+}
 
-    /*
-     * let the max gain fade away
-     */
-    for (int j = 0; j < FM_VOICE_CNT; j++)
+/*
+ * block setup, called before any voice is rendered
+ */
+void FmEngine::BlockBegin(int bufLen)
+{
+    blockLen = bufLen;
+
+    processGain = 1.0f;
+#ifdef PRESSURE_SENSOR_ENABLED
+    for (int n = 0; n < bufLen; n++)
     {
-        fmVoice[j].outSlow *= 0.99f;
+        pressureValueFilt = pressureValueFilt * 0.99f + pressureValue * 0.01f;
     }
+    processGain = pressureValueFilt;
+#endif
+
+    LfoUpdate(bufLen);
+    ChannelPitchUpdate();
+}
 
+void FmEngine::BlockEnd(int bufLen)
+{
     if (initChannelSetting)
     {
         initChannelSettingCnt++;
@@ -1519,118 +1658,242 @@ void FmSynth_Process(const float *in __attribute__((unused)), float *out, int bu
             FmSynth_InitChannelSettings(currentChSetting);
         }
     }
-    else
+    else
+    {
+        initChannelSettingCnt = 0;
+    }
+}
+
+void FmEngine::Process(const float *in __attribute__((unused)), float *out, int bufLen)
+{
+    BlockBegin(bufLen);
+
+    const float gain = processGain;
+
+#ifdef FM_FIXED_POINT_ENABLED
+    /* the voices are mixed in integer, the conversion is done once per output sample */
+    int32_t mix[FM_MIX_BLOCK];
+
+    for (int n = 0; n < bufLen; n += FM_MIX_BLOCK)
+    {
+        uint32_t len = ((bufLen - n) < FM_MIX_BLOCK) ? (bufLen - n) : FM_MIX_BLOCK;
+
+        memset(mix, 0, sizeof(int32_t) * len);
+
+        ProcessVoiceList(&fmVoiceHeld, mix, n, len, gain);
+        ProcessVoiceList(&fmVoiceReleased, mix, n, len, gain);
+
+        for (uint32_t i = 0; i < len; i++)
+        {
+            out[n + i] = mix[i] * (1.0f / 8.0f / 32768.0f);
+        }
+    }
+#else
+    for (int n = 0; n < bufLen; n++)
+    {
+        out[n] = 0.0f;
+    }
+
+    ProcessVoiceList(&fmVoiceHeld, out, 0, bufLen, gain);
+    ProcessVoiceList(&fmVoiceReleased, out, 0, bufLen, gain);
+
+    for (int n = 0; n < bufLen; n++)
+    {
+        out[n] *= 1.0f / 8.0f;
+    }
+#endif
+
+    BlockEnd(bufLen);
+}
+
+/*
+ * rendering a block on multiple threads / cores:
+ * - FmSynth_ProcessBegin is called once
+ * - FmSynth_ProcessPart is called for every part (0..partCnt-1), each can run on its own thread
+ * - FmSynth_ProcessEnd is called after all parts have been finished, it sums the partial buffers
+ * other FmSynth functions (NoteOn etc.) must not be called while parts are rendered
+ */
+void FmEngine::ProcessBegin(int bufLen)
+{
+    BlockBegin(bufLen);
+}
+
+/*
+ * renders every partCnt-th voice (starting with part) to partial
+ * the voice lists are not touched, so the parts can be rendered concurrently
+ */
+void FmEngine::ProcessVoicePart(uint32_t part, uint32_t partCnt, fm_sample_t *out, uint32_t pos, uint32_t len)
+{
+    for (uint32_t j = part; j < fmVoiceCnt; j += partCnt)
+    {
+        if (fmVoice[j].active)
+        {
+            ProcessVoice(&fmVoice[j], out, pos, len, processGain);
+        }
+    }
+}
+
+void FmEngine::ProcessPart(uint32_t part, uint32_t partCnt, float *partial, int bufLen)
+{
+#ifdef FM_FIXED_POINT_ENABLED
+    int32_t mix[FM_MIX_BLOCK];
+
+    for (int n = 0; n < bufLen; n += FM_MIX_BLOCK)
+    {
+        uint32_t len = ((bufLen - n) < FM_MIX_BLOCK) ? (bufLen - n) : FM_MIX_BLOCK;
+
+        memset(mix, 0, sizeof(int32_t) * len);
+
+        ProcessVoicePart(part, partCnt, mix, n, len);
+
+        for (uint32_t i = 0; i < len; i++)
+        {
+            partial[n + i] = mix[i] * (1.0f / 8.0f / 32768.0f);
+        }
+    }
+#else
+    for (int n = 0; n < bufLen; n++)
+    {
+        partial[n] = 0.0f;
+    }
+
+    ProcessVoicePart(part, partCnt, partial, 0, bufLen);
+
+    for (int n = 0; n < bufLen; n++)
     {
-        initChannelSettingCnt = 0;
+        partial[n] *= 1.0f / 8.0f;
     }
+#endif
 }
 
-struct synthVoice_s *FmSynth_GetQuietestVoice(void)
+/*
+ * returns the voices of a list which became quiet to the free list
+ */
+void FmEngine::VoiceListCollect(struct fmVoiceList_s *list)
 {
-    /*
-     * if all voices at full velocity then going round
-     */
-    static uint8_t roundCnt = 0;
-    roundCnt++;
-    if (roundCnt >= FM_VOICE_CNT)
+    struct synthVoice_s *voice = list->head;
+
+    while (voice != NULL)
     {
-        roundCnt = 0;
-    }
+        struct synthVoice_s *next = voice->next;
 
-    struct synthVoice_s *foundVoice = &fmVoice[roundCnt];
+        if (!voice->active)
+        {
+            FmSynth_VoiceMove(voice, &fmVoiceFree);
+        }
 
-    float quietestVoice = 10.0f;
+        voice = next;
+    }
+}
 
-    for (int i = 0; i < FM_VOICE_CNT; i++)
+void FmEngine::ProcessEnd(float **partials, uint32_t partCnt, float *out, int bufLen)
+{
+    for (int n = 0; n < bufLen; n++)
     {
-        struct synthVoice_s *voice = &fmVoice[i];
-
-        if (voice->outSlow < quietestVoice)
+        float sum = 0.0f;
+        for (uint32_t p = 0; p < partCnt; p++)
         {
-            quietestVoice = voice->outSlow;
-            foundVoice = voice;
+            sum += partials[p][n];
         }
+        out[n] = sum;
     }
 
-    return foundVoice;
+    VoiceListCollect(&fmVoiceHeld);
+    VoiceListCollect(&fmVoiceReleased);
+
+    BlockEnd(bufLen);
 }
 
-void FmSynth_NoteOn(uint8_t ch, uint8_t note, float vel)
+/*
+ * order of voice allocation (all O(1)):
+ * - a voice which is not sounding
+ * - the voice which has been released first
+ * - the oldest voice which is still held
+ */
+struct synthVoice_s *FmEngine::AllocVoice(void)
 {
-    if (ch < MIDI_CH_CNT)
+    struct synthVoice_s *voice = fmVoiceFree.head;
+
+    if (voice == NULL)
     {
-        currentChSetting = &channelSettings[ch];
+        voice = fmVoiceReleased.head;
+    }
+    if (voice == NULL)
+    {
+        voice = fmVoiceHeld.head;
+    }
+    if (voice == NULL)
+    {
+        return NULL; /* no voice memory */
     }
 
-    bool tonesFound = false;
+    FmSynth_VoiceMove(voice, &fmVoiceHeld);
 
-    struct synthVoice_s *newVoice = FmSynth_GetQuietestVoice();
+    return voice;
+}
 
-    synthTone_s *tones[4];
+void FmEngine::NoteOn(uint8_t ch, uint8_t note, float vel)
+{
+    if (ch < MIDI_CH_CNT)
+    {
+        currentChSetting = &channelSettings[ch];
+    }
 
-    tonesFound = true;
-    tones[0] = &newVoice->op[OP4];
-    tones[1] = &newVoice->op[OP3];
-    tones[2] = &newVoice->op[OP2];
-    tones[3] = &newVoice->op[OP1];
+    struct synthVoice_s *newVoice = AllocVoice();
+    if (newVoice == NULL)
+    {
+        return;
+    }
 
     newVoice->midiCh = ch;
     newVoice->midiNote = note;
     newVoice->settings = currentChSetting;
+    newVoice->active = true;
 
-    newVoice->outSlow = 5.0f; /* ensure it will not be killed by next MIDI note on */
-
-    if (tonesFound)
+    if (currentChSetting->mono)
     {
-        if (currentChSetting->mono)
-        {
-            currentChSetting->notes[currentChSetting->noteStackCnt++] = note;
-        }
-        float tonePitch = ((pow(2.0f, (float)(note - 69) / 12.0f) * 440.0f));
-        struct synthTone_s *tone;
-
-        tone = tones[OP4];
-        FmSynth_ToneInit(tone, &currentChSetting->op_prop[OP4]);
-        tone->pitch = tonePitch;
-        tone->vel *= (1.0f - tone->op_prop->vel_to_tl) + tone->op_prop->vel_to_tl * vel;
-
-        tone = tones[OP3];
-        FmSynth_ToneInit(tone, &currentChSetting->op_prop[OP3]);
-        tone->pitch = tonePitch;
-
-        tone->vel *= (1.0f - tone->op_prop->vel_to_tl) + tone->op_prop->vel_to_tl * vel;
+        currentChSetting->notes[currentChSetting->noteStackCnt++] = note;
+    }
 
-        tone = tones[OP2];
-        FmSynth_ToneInit(tone, &currentChSetting->op_prop[OP2]);
-        tone->pitch = tonePitch;
-        tone->vel *= (1.0f - tone->op_prop->vel_to_tl) + tone->op_prop->vel_to_tl * vel;
+    newVoice->pitch = ((pow(2.0f, (float)(note - 69) / 12.0f) * 440.0f));
+    newVoice->pitchMultiplier = 0.0f; /* start without glide */
 
-        tone = tones[OP1];
-        FmSynth_ToneInit(tone, &currentChSetting->op_prop[OP1]);
-        tone->pitch = tonePitch;
-        tone->vel *= (1.0f - tone->op_prop->vel_to_tl) + tone->op_prop->vel_to_tl * vel;
+    for (int i = 0; i < 4; i++)
+    {
+        FmSynth_ToneInit(newVoice, i, &currentChSetting->op_prop[i]);
+        newVoice->vel[i] *= (1.0f - newVoice->op_prop[i]->vel_to_tl) + newVoice->op_prop[i]->vel_to_tl * vel;
     }
 }
 
-void FmSynth_NoteOff(uint8_t ch, uint8_t note)
+void FmEngine::NoteOff(uint8_t ch, uint8_t note)
 {
     /*
      * find matching note and put into release
      */
-    for (int i = 0; i < FM_VOICE_CNT ; i++)
+    struct synthVoice_s *voice = fmVoiceHeld.head;
+
+    while (voice != NULL)
     {
-        if ((fmVoice[i].midiNote == note) && (fmVoice[i].midiCh == ch))
+        struct synthVoice_s *next = voice->next;
+
+        if ((voice->midiNote == note) && (voice->midiCh == ch))
         {
             for (int j = 0; j < 4; j++)
             {
-                fmVoice[i].op[j].state = ENV_RELEASE;
-                FmSynth_ToneEnvUpdate(&fmVoice[i].op[j]);
+                if (voice->state[j] != ENV_OFF)
+                {
+                    voice->state[j] = ENV_RELEASE;
+                    FmSynth_ToneEnvUpdate(voice, j);
+                }
             }
+            FmSynth_VoiceMove(voice, &fmVoiceReleased);
         }
+
+        voice = next;
     }
 }
 
-void FmSynth_ChannelSettingDump(uint8_t ch __attribute__((unused)), float value)
+void FmEngine::ChannelSettingDump(uint8_t ch __attribute__((unused)), float value)
 {
     if (value > 0)
     {
@@ -1644,6 +1907,8 @@ void FmSynth_ChannelSettingDump(uint8_t ch __attribute__((unused)), float value)
             printf("setting->op_prop[%d].d2r = %" PRIu32 ";\n", i, currentChSetting->op_prop[i].d2r);
             printf("setting->op_prop[%d].rr = %" PRIu32 ";\n", i, currentChSetting->op_prop[i].rr);
             printf("setting->op_prop[%d].rs = %" PRIu32 ";\n", i, currentChSetting->op_prop[i].rs);
+            printf("setting->op_prop[%d].ks = %d;\n", i, currentChSetting->op_prop[i].ks);
+            printf("setting->op_prop[%d].ssgeg = %d;\n", i, currentChSetting->op_prop[i].ssgeg);
             printf("setting->op_prop[%d].tl = %0.6f;\n", i, currentChSetting->op_prop[i].tl);
             printf("setting->op_prop[%d].mul = %0.6f;\n", i, currentChSetting->op_prop[i].mul);
             printf("setting->op_prop[%d].vel_to_tl = %0.6f;\n", i, currentChSetting->op_prop[i].vel_to_tl);
@@ -1651,10 +1916,130 @@ void FmSynth_ChannelSettingDump(uint8_t ch __attribute__((unused)), float value)
             printf("setting->op_prop[%d].mw = %0.6f;\n", i, currentChSetting->op_prop[i].mw);
             printf("setting->op_prop[%d].vel = %0.6f;\n", i, currentChSetting->op_prop[i].vel);
         }
+        printf("setting->props.lfo_enable = %0.6f;\n", currentChSetting->props.lfo_enable);
+        printf("setting->props.lfo_speed = %0.6f;\n", currentChSetting->props.lfo_speed);
+        printf("setting->props.fms = %0.6f;\n", currentChSetting->props.fms);
+        printf("setting->props.fmsmw = %0.6f;\n", currentChSetting->props.fmsmw);
+        printf("setting->props.ams = %0.6f;\n", currentChSetting->props.ams);
+
+        /* same as above in the format of fmBankDefault */
+        struct fm_patch_s patch;
+        FmSynth_PatchPack(&patch, currentChSetting);
+        printf("{\n");
+        printf("    %d, %d, %d, 0,\n", patch.algo, patch.feedback, patch.flags);
+        printf("    {\n");
+        for (int i = 0; i < 4; i++)
+        {
+            const struct fm_patch_op_s *op = &patch.op[i];
+            printf("        { %d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d, 0 },\n",
+                   op->ar, op->d1r, op->d2r, op->rr, op->mul, op->rs, op->d2l, op->tl, op->vel_to_tl, op->am, op->mw, op->vel, op->ks, op->ssgeg);
+        }
+        printf("    }\n");
+        printf("},\n");
+    }
+}
+
+/*
+ * loads a patch of the current bank to a channel
+ */
+void FmEngine::ProgramChange(uint8_t ch, uint8_t program)
+{
+    if ((ch < MIDI_CH_CNT) && (program < fmBankCnt))
+    {
+        FmSynth_PatchUnpack(&channelSettings[ch], &fmBank[program]);
+        PitchInvalidate();
     }
 }
 
-void FmSynth_ChannelSettingInit(uint8_t ch __attribute__((unused)), float value)
+#ifdef FM_BANK_FS_ENABLED
+/*
+ * loads a bank file to memory, the patches can be selected using FmSynth_ProgramChange afterwards
+ */
+bool FmEngine::BankLoad(fs_id_t id, const char *filename)
+{
+    struct fm_bank_hdr_s hdr;
+
+    if (!FS_OpenFile(id, filename, "r"))
+    {
+        return false;
+    }
+
+    if ((readBytes((uint8_t *)&hdr, sizeof(hdr)) != sizeof(hdr)) || (memcmp(hdr.magic, "FMBK", 4) != 0)
+        || (hdr.version != FM_BANK_VERSION) || (hdr.patchSize != sizeof(struct fm_patch_s)))
+    {
+        Status_LogMessage("not a valid fm bank file\n");
+        FS_CloseFile();
+        return false;
+    }
+
+    uint32_t patchCnt = (hdr.patchCnt < FM_BANK_PATCH_CNT) ? hdr.patchCnt : FM_BANK_PATCH_CNT;
+    uint32_t len = patchCnt * sizeof(struct fm_patch_s);
+
+    /* a truncated file is refused before the current bank gets touched */
+    if (availableBytes() < len)
+    {
+        Status_LogMessage("fm bank file too short\n");
+        FS_CloseFile();
+        return false;
+    }
+
+    bool ok = readBytes((uint8_t *)fmBankRam, len) == len;
+
+    FS_CloseFile();
+
+    if (!ok)
+    {
+        /* the ram bank might be incomplete */
+        Status_LogMessage("error reading fm bank file\n");
+        fmBank = fmBankDefault;
+        fmBankCnt = MIDI_CH_CNT;
+        return false;
+    }
+
+    fmBank = fmBankRam;
+    fmBankCnt = patchCnt;
+
+    return true;
+}
+
+/*
+ * writes the current settings of all channels as bank file
+ */
+bool FmEngine::BankSave(fs_id_t id, const char *filename)
+{
+    struct fm_bank_hdr_s hdr;
+
+    memcpy(hdr.magic, "FMBK", 4);
+    hdr.version = FM_BANK_VERSION;
+    hdr.patchSize = sizeof(struct fm_patch_s);
+    hdr.patchCnt = MIDI_CH_CNT;
+
+    if (!FS_OpenFile(id, filename, "w"))
+    {
+        return false;
+    }
+
+    bool ok = writeBytes((uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr);
+
+    for (int ch = 0; ok && (ch < MIDI_CH_CNT); ch++)
+    {
+        struct fm_patch_s patch;
+        FmSynth_PatchPack(&patch, &channelSettings[ch]);
+        ok = writeBytes((uint8_t *)&patch, sizeof(patch)) == sizeof(patch);
+    }
+
+    FS_CloseFile();
+
+    if (!ok)
+    {
+        Status_LogMessage("error writing fm bank file\n");
+    }
+
+    return ok;
+}
+#endif /* FM_BANK_FS_ENABLED */
+
+void FmEngine::ChannelSettingInit(uint8_t ch __attribute__((unused)), float value)
 {
     if (value > 0)
     {
@@ -1666,24 +2051,27 @@ void FmSynth_ChannelSettingInit(uint8_t ch __attribute__((unused)), float value)
     }
 }
 
-void FmSynth_PitchBend(uint8_t ch __attribute__((unused)), float bend)
+void FmEngine::PitchBend(uint8_t ch, float bend)
 {
-    pitchBendValue = bend;
+    if (ch < MIDI_CH_CNT)
+    {
+        pitchBendValue[ch] = bend;
+    }
 }
 
-void FmSynth_ModulationWheel(uint8_t ch __attribute__((unused)), float value)
+void FmEngine::ModulationWheel(uint8_t ch __attribute__((unused)), float value)
 {
     modulationDepth = value;
 }
 
 #ifdef PRESSURE_SENSOR_ENABLED
-void FmSynth_Pressure(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::Pressure(uint8_t unused __attribute__((unused)), float value)
 {
     pressureValue = value;
 }
 #endif
 
-void FmSynth_ToggleMono(uint8_t param __attribute__((unused)), float value)
+void FmEngine::ToggleMono(uint8_t param __attribute__((unused)), float value)
 {
     if (value > 0)
     {
@@ -1698,7 +2086,7 @@ void FmSynth_ToggleMono(uint8_t param __attribute__((unused)), float value)
     }
 }
 
-void FmSynth_ToggleLegato(uint8_t param __attribute__((unused)), float value)
+void FmEngine::ToggleLegato(uint8_t param __attribute__((unused)), float value)
 {
     if (value > 0)
     {
@@ -1713,7 +2101,7 @@ void FmSynth_ToggleLegato(uint8_t param __attribute__((unused)), float value)
     }
 }
 
-void FmSynth_SelectOp(uint8_t param, float value)
+void FmEngine::SelectOp(uint8_t param, float value)
 {
     if (value > 0)
     {
@@ -1725,7 +2113,7 @@ void FmSynth_SelectOp(uint8_t param, float value)
     }
 }
 
-void FmSynth_SetAlgorithm(uint8_t param, float value)
+void FmEngine::SetAlgorithm(uint8_t param, float value)
 {
     if (value > 0)
     {
@@ -1734,7 +2122,7 @@ void FmSynth_SetAlgorithm(uint8_t param, float value)
     }
 }
 
-void FmSynth_ChangeParam(uint8_t param, float value)
+void FmEngine::ChangeParam(uint8_t param, float value)
 {
     switch (param)
     {
@@ -1757,6 +2145,7 @@ void FmSynth_ChangeParam(uint8_t param, float value)
 
             currentChSetting->op_prop[selectedOp].mul_coarse = mul_c;
             currentChSetting->op_prop[selectedOp].mul = currentChSetting->op_prop[selectedOp].mul_coarse + currentChSetting->op_prop[selectedOp].mul_fine;
+            PitchInvalidate();
             Status_ValueChangedFloatArr("op_mul", currentChSetting->op_prop[selectedOp].mul, 4 - selectedOp);
         }
         break;
@@ -1766,6 +2155,7 @@ void FmSynth_ChangeParam(uint8_t param, float value)
 
             currentChSetting->op_prop[selectedOp].mul_fine = (float)u32 * 0.01f;
             currentChSetting->op_prop[selectedOp].mul = currentChSetting->op_prop[selectedOp].mul_coarse + currentChSetting->op_prop[selectedOp].mul_fine;
+            PitchInvalidate();
             Status_ValueChangedFloatArr("op_mul", currentChSetting->op_prop[selectedOp].mul, 4 - selectedOp);
         }
         break;
@@ -1773,56 +2163,296 @@ void FmSynth_ChangeParam(uint8_t param, float value)
     }
 }
 
-void FmSynth_VelToLev(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::VelToLev(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].vel_to_tl = value;
     Status_ValueChangedFloatArr("vel_to_tl", currentChSetting->op_prop[selectedOp].vel_to_tl, 4 - selectedOp);
 }
 
-void FmSynth_LfoAM(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::LfoAM(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].am = value;
     Status_ValueChangedFloatArr("op_lfo_am", currentChSetting->op_prop[selectedOp].am, 4 - selectedOp);
 }
 
-void FmSynth_LfoFM(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::LfoFM(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].mw = value;
     Status_ValueChangedFloatArr("op_lfo_mw", currentChSetting->op_prop[selectedOp].mw, 4 - selectedOp);
 }
 
-void FmSynth_Attack(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::ToggleLfo(uint8_t param __attribute__((unused)), float value)
+{
+    if (value > 0)
+    {
+        currentChSetting->props.lfo_enable = (currentChSetting->props.lfo_enable > 0.0f) ? 0.0f : 1.0f;
+        Status_ValueChangedInt("lfo_enable", currentChSetting->props.lfo_enable > 0.0f);
+    }
+}
+
+void FmEngine::LfoSpeed(uint8_t unused __attribute__((unused)), float value)
+{
+    currentChSetting->props.lfo_speed = 0.1f + value * value * 20.0f;
+    Status_ValueChangedFloat("lfo_speed", currentChSetting->props.lfo_speed);
+}
+
+void FmEngine::LfoFms(uint8_t unused __attribute__((unused)), float value)
+{
+    currentChSetting->props.fms = value * 3.0f;
+    Status_ValueChangedFloat("lfo_fms", currentChSetting->props.fms);
+}
+
+void FmEngine::LfoAms(uint8_t unused __attribute__((unused)), float value)
+{
+    currentChSetting->props.ams = value;
+    Status_ValueChangedFloat("lfo_ams", currentChSetting->props.ams);
+}
+
+void FmEngine::Attack(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].ar = pow(2, value * 15);
     Status_ValueChangedFloatArr("op_attackRate", currentChSetting->op_prop[selectedOp].ar, 4 - selectedOp);
 }
 
-void FmSynth_Decay1(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::Decay1(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].d1r = pow(2, value * 15);
     Status_ValueChangedFloatArr("op_decay1rate", currentChSetting->op_prop[selectedOp].d1r, 4 - selectedOp);
 }
 
-void FmSynth_DecayL(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::DecayL(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].d2l = value;
     Status_ValueChangedFloatArr("op_decay2level", currentChSetting->op_prop[selectedOp].d2l, 4 - selectedOp);
 }
 
-void FmSynth_Decay2(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::Decay2(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].d2r = pow(2, value * 15);
     Status_ValueChangedFloatArr("op_decay2rate", currentChSetting->op_prop[selectedOp].d2r, 4 - selectedOp);
 }
 
-void FmSynth_Release(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::Release(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->op_prop[selectedOp].rr = pow(2, value * 12);
     Status_ValueChangedFloatArr("op_releaseRate", currentChSetting->op_prop[selectedOp].rr, 4 - selectedOp);
 }
 
-void FmSynth_Feedback(uint8_t unused __attribute__((unused)), float value)
+void FmEngine::KeyScale(uint8_t unused __attribute__((unused)), float value)
+{
+    currentChSetting->op_prop[selectedOp].ks = value * 3;
+    Status_ValueChangedIntArr("op_keyScale", currentChSetting->op_prop[selectedOp].ks, 4 - selectedOp);
+}
+
+void FmEngine::SsgEg(uint8_t unused __attribute__((unused)), float value)
+{
+    currentChSetting->op_prop[selectedOp].ssgeg = value * (float)ssgeg_once_high_inv;
+    Status_ValueChangedIntArr("op_ssgEg", currentChSetting->op_prop[selectedOp].ssgeg, 4 - selectedOp);
+}
+
+void FmEngine::Feedback(uint8_t unused __attribute__((unused)), float value)
 {
     currentChSetting->fmFeedback = value;
     Status_ValueChangedFloat("feedback", currentChSetting->fmFeedback);
 }
+
+/*
+ * default instance used by the FmSynth_ functions
+ */
+static FmEngine fmEngine;
+static struct synthVoice_s fmVoiceDefault[FM_VOICE_CNT];
+
+uint32_t FmSynth_VoiceMemSize(uint32_t voice_cnt)
+{
+    return FmEngine::VoiceMemSize(voice_cnt);
+}
+
+void FmSynth_Init(float sample_rate_in)
+{
+    fmEngine.Init(sample_rate_in, fmVoiceDefault, FM_VOICE_CNT);
+}
+
+void FmSynth_Init(float sample_rate_in, void *voice_mem, uint32_t voice_cnt)
+{
+    if ((voice_mem == NULL) || (voice_cnt == 0))
+    {
+        Status_LogMessage("no memory for fm voices, using default\n");
+        voice_mem = fmVoiceDefault;
+        voice_cnt = FM_VOICE_CNT;
+    }
+    fmEngine.Init(sample_rate_in, voice_mem, voice_cnt);
+}
+
+void FmSynth_Process(const float *in, float *out, int bufLen)
+{
+    fmEngine.Process(in, out, bufLen);
+}
+
+void FmSynth_ProcessBegin(int bufLen)
+{
+    fmEngine.ProcessBegin(bufLen);
+}
+
+void FmSynth_ProcessPart(uint32_t part, uint32_t partCnt, float *partial, int bufLen)
+{
+    fmEngine.ProcessPart(part, partCnt, partial, bufLen);
+}
+
+void FmSynth_ProcessEnd(float **partials, uint32_t partCnt, float *out, int bufLen)
+{
+    fmEngine.ProcessEnd(partials, partCnt, out, bufLen);
+}
+
+void FmSynth_NoteOn(uint8_t ch, uint8_t note, float vel)
+{
+    fmEngine.NoteOn(ch, note, vel);
+}
+
+void FmSynth_NoteOff(uint8_t ch, uint8_t note)
+{
+    fmEngine.NoteOff(ch, note);
+}
+
+void FmSynth_PitchBend(uint8_t ch, float bend)
+{
+    fmEngine.PitchBend(ch, bend);
+}
+
+void FmSynth_ModulationWheel(uint8_t ch, float value)
+{
+    fmEngine.ModulationWheel(ch, value);
+}
+
+#ifdef PRESSURE_SENSOR_ENABLED
+void FmSynth_Pressure(uint8_t unused, float value)
+{
+    fmEngine.Pressure(unused, value);
+}
+#endif
+
+void FmSynth_ChannelSettingDump(uint8_t ch, float value)
+{
+    fmEngine.ChannelSettingDump(ch, value);
+}
+
+void FmSynth_ChannelSettingInit(uint8_t ch, float value)
+{
+    fmEngine.ChannelSettingInit(ch, value);
+}
+
+void FmSynth_ProgramChange(uint8_t ch, uint8_t program)
+{
+    fmEngine.ProgramChange(ch, program);
+}
+
+#ifdef FM_BANK_FS_ENABLED
+bool FmSynth_BankLoad(fs_id_t id, const char *filename)
+{
+    return fmEngine.BankLoad(id, filename);
+}
+
+bool FmSynth_BankSave(fs_id_t id, const char *filename)
+{
+    return fmEngine.BankSave(id, filename);
+}
+#endif
+
+void FmSynth_ToggleMono(uint8_t param, float value)
+{
+    fmEngine.ToggleMono(param, value);
+}
+
+void FmSynth_ToggleLegato(uint8_t param, float value)
+{
+    fmEngine.ToggleLegato(param, value);
+}
+
+void FmSynth_SelectOp(uint8_t param, float value)
+{
+    fmEngine.SelectOp(param, value);
+}
+
+void FmSynth_SetAlgorithm(uint8_t param, float value)
+{
+    fmEngine.SetAlgorithm(param, value);
+}
+
+void FmSynth_ChangeParam(uint8_t param, float value)
+{
+    fmEngine.ChangeParam(param, value);
+}
+
+void FmSynth_VelToLev(uint8_t unused, float value)
+{
+    fmEngine.VelToLev(unused, value);
+}
+
+void FmSynth_LfoAM(uint8_t unused, float value)
+{
+    fmEngine.LfoAM(unused, value);
+}
+
+void FmSynth_LfoFM(uint8_t unused, float value)
+{
+    fmEngine.LfoFM(unused, value);
+}
+
+void FmSynth_Attack(uint8_t unused, float value)
+{
+    fmEngine.Attack(unused, value);
+}
+
+void FmSynth_Decay1(uint8_t unused, float value)
+{
+    fmEngine.Decay1(unused, value);
+}
+
+void FmSynth_DecayL(uint8_t unused, float value)
+{
+    fmEngine.DecayL(unused, value);
+}
+
+void FmSynth_Decay2(uint8_t unused, float value)
+{
+    fmEngine.Decay2(unused, value);
+}
+
+void FmSynth_Release(uint8_t unused, float value)
+{
+    fmEngine.Release(unused, value);
+}
+
+void FmSynth_KeyScale(uint8_t unused, float value)
+{
+    fmEngine.KeyScale(unused, value);
+}
+
+void FmSynth_SsgEg(uint8_t unused, float value)
+{
+    fmEngine.SsgEg(unused, value);
+}
+
+void FmSynth_Feedback(uint8_t unused, float value)
+{
+    fmEngine.Feedback(unused, value);
+}
+
+void FmSynth_ToggleLfo(uint8_t param, float value)
+{
+    fmEngine.ToggleLfo(param, value);
+}
+
+void FmSynth_LfoSpeed(uint8_t unused, float value)
+{
+    fmEngine.LfoSpeed(unused, value);
+}
+
+void FmSynth_LfoFms(uint8_t unused, float value)
+{
+    fmEngine.LfoFms(unused, value);
+}
+
+void FmSynth_LfoAms(uint8_t unused, float value)
+{
+    fmEngine.LfoAms(unused, value);
+}
@@ -53,6 +53,9 @@
 
 
 #include <inttypes.h>
+#ifdef FM_BANK_FS_ENABLED
+#include <fs/fs_access.h> /* fs_id_t */
+#endif
 
 
 class SineSynth
@@ -70,8 +73,313 @@ private:
 };
 
 
+#ifndef FM_VOICE_CNT
+#define FM_VOICE_CNT    6 /* voices used by FmSynth_Init without voice memory */
+#endif
+
+#define FM_MIDI_CH_CNT  16
+
+#ifndef FM_BANK_PATCH_CNT
+#define FM_BANK_PATCH_CNT   FM_MIDI_CH_CNT /* max number of patches loaded from a bank file */
+#endif
+
+#ifdef FM_FIXED_POINT_ENABLED
+typedef int32_t fm_sample_t; /* Q15 */
+#else
+typedef float fm_sample_t;
+#endif
+
+typedef uint8_t envState_t;
+
+/*
+ * the types below are used internally by FmEngine
+ */
+
+struct op_properties_s
+{
+    float mw; /* mod wheel  to amplitude */
+    float am; /* amplitude modulation toggle, the depth is set by ams of the channel */
+
+    uint32_t ar; /* attack */
+    uint32_t d1r; /* decay until d2l */
+    uint32_t d2r; /* */
+    float d2l; /* decay level */
+    uint32_t rr;
+    uint32_t rs; /* key rate dings, make envelope faster or slower */
+
+    uint8_t ssgeg; /* software controlled sound generator - envelope behavior (ssg_eg_e) */
+    uint8_t ks; /* key scaling 0..3, higher notes are using shorter envelopes */
+    float mul;
+
+    float mul_fine;
+    float mul_coarse;
+
+    float fixed;
+    float dt; /* detune */
+    float vel; /* hm for what is this good for? */
+    float tl; /* total level: envelope amplitude */
+
+    float vel_to_tl; /* addon to push MIDI vel to tl */
+};
+
+struct custom_properties_s
+{
+    float feedback; /* op1 feedback */
+
+    float lfo_enable;
+    float lfo_speed; /* in Hz */
+    float fms; /* pitch modulation sensitivity in semitones (up to 3) */
+    float fmsmw; /* pitch modulation in semitones with the mod wheel fully up */
+    float ams; /* amplitude modulation sensitivity (0..1) */
+
+    float legato_retrig;
+    float pitchbend_range;
+    float volume;
+    float alg;
+};
+
+struct channelSettingParam_s
+{
+    struct custom_properties_s props;
+    struct op_properties_s op_prop[4];
+
+    float fmFeedback;
+
+    int algo;
+
+    bool mono;
+    bool legato;
+
+    uint8_t notes[16];
+    uint8_t noteStackCnt;
+};
+
+/*
+ * the operator state is kept as structure of arrays, the index is the operator
+ * - all operators of a voice are independent within one sample
+ *   (modulation is applied with one sample delay) which allows the compiler to vectorize
+ */
+struct synthVoice_s
+{
+    uint32_t pos[4];
+    uint32_t add[4]; /* phase increment, updated when the pitch changes */
+    int32_t addStep[4]; /* per sample change of add within the current block */
+    fm_sample_t in[4];
+    fm_sample_t out[4];
+    uint32_t eg_att[4]; /* attenuation, FM_EG_FRAC fractional bits */
+    uint32_t eg_add[4]; /* linear increase of the attenuation per sample */
+    uint32_t eg_mul[4]; /* attack: part of the attenuation removed per sample (2^-32) */
+    uint32_t eg_target[4]; /* attenuation at the end of the current state */
+    fm_sample_t gain[4]; /* tl * vel, updated once per block */
+    fm_sample_t gainStep[4]; /* per sample change of gain, used by the lfo amplitude modulation */
+    fm_sample_t feedback; /* updated once per block */
+    int32_t stateLen[4];
+    uint8_t ssgInv[4]; /* ssg-eg output is inverted */
+    uint8_t ssgToggle[4]; /* ssg-eg alternate state */
+
+    float vel[4];
+    envState_t state[4];
+
+    struct op_properties_s *op_prop[4];
+
+    float pitch;
+    float pitchMultiplier; /* used to calculate add */
+    bool active;
+
+    uint8_t midiNote;
+    uint8_t midiCh;
+
+    struct channelSettingParam_s *settings;
+
+    /* voice pool */
+    struct synthVoice_s *prev;
+    struct synthVoice_s *next;
+    struct fmVoiceList_s *list;
+};
+
+/*
+ * the voices are always in one of the lists below
+ * - new voices are added to the tail, so the head is the oldest voice
+ */
+struct fmVoiceList_s
+{
+    struct synthVoice_s *head;
+    struct synthVoice_s *tail;
+};
+
+/*
+ * packed patch, used for the preset bank in flash and for bank files
+ * - levels are 7 bit values like the MIDI controllers (127 is 1.0)
+ * - multi byte values are little endian
+ */
+struct fm_patch_op_s
+{
+    uint16_t ar;
+    uint16_t d1r;
+    uint16_t d2r;
+    uint16_t rr;
+    uint16_t mul; /* multiplier * 100 */
+    uint8_t rs;
+    uint8_t d2l;
+    uint8_t tl;
+    uint8_t vel_to_tl;
+    uint8_t am;
+    uint8_t mw;
+    uint8_t vel;
+    uint8_t ks;
+    uint8_t ssgeg;
+    uint8_t reserved;
+};
+
+struct fm_patch_lfo_s
+{
+    uint16_t speed; /* Hz * 100 */
+    uint16_t fms; /* cent */
+    uint16_t fmsmw; /* cent */
+    uint8_t enable;
+    uint8_t ams;
+};
+
+struct fm_patch_s
+{
+    uint8_t algo;
+    uint8_t feedback;
+    uint8_t flags; /* bit 0: mono, bit 1: legato */
+    uint8_t reserved;
+    struct fm_patch_lfo_s lfo;
+    struct fm_patch_op_s op[4];
+};
+
+/*
+ * FM synthesizer engine, each instance owns its settings and plays the voice memory passed to Init
+ * the FmSynth_ functions are using a default instance with FM_VOICE_CNT voices
+ */
+class FmEngine
+{
+public:
+    FmEngine();
+    ~FmEngine() {};
+
+    static uint32_t VoiceMemSize(uint32_t voice_cnt);
+    void Init(float sample_rate_in);
+    void Init(float sample_rate_in, void *voice_mem, uint32_t voice_cnt);
+    void Process(const float *in, float *out, int bufLen);
+    void ProcessBegin(int bufLen);
+    void ProcessPart(uint32_t part, uint32_t partCnt, float *partial, int bufLen);
+    void ProcessEnd(float **partials, uint32_t partCnt, float *out, int bufLen);
+    void NoteOn(uint8_t ch, uint8_t note, float vel);
+    void NoteOff(uint8_t ch, uint8_t note);
+    void PitchBend(uint8_t ch, float bend);
+    void ModulationWheel(uint8_t ch, float value);
+#ifdef PRESSURE_SENSOR_ENABLED
+    void Pressure(uint8_t unused, float value);
+#endif
+
+    void ChannelSettingDump(uint8_t ch, float value);
+    void ChannelSettingInit(uint8_t ch, float value);
+    void ProgramChange(uint8_t ch, uint8_t program);
+#ifdef FM_BANK_FS_ENABLED
+    bool BankLoad(fs_id_t id, const char *filename);
+    bool BankSave(fs_id_t id, const char *filename);
+#endif
+    void ToggleMono(uint8_t param, float value);
+    void ToggleLegato(uint8_t param, float value);
+    void SelectOp(uint8_t param, float value);
+    void SetAlgorithm(uint8_t param, float value);
+    void ChangeParam(uint8_t param, float value);
+    void VelToLev(uint8_t unused, float value);
+    void LfoAM(uint8_t unused, float value);
+    void LfoFM(uint8_t unused, float value);
+    void Attack(uint8_t unused, float value);
+    void Decay1(uint8_t unused, float value);
+    void DecayL(uint8_t unused, float value);
+    void Decay2(uint8_t unused, float value);
+    void Release(uint8_t unused, float value);
+    void KeyScale(uint8_t unused, float value);
+    void SsgEg(uint8_t unused, float value);
+    void Feedback(uint8_t unused, float value);
+    void ToggleLfo(uint8_t param, float value);
+    void LfoSpeed(uint8_t unused, float value);
+    void LfoFms(uint8_t unused, float value);
+    void LfoAms(uint8_t unused, float value);
+
+private:
+    void InitVoice(struct synthVoice_s *voice);
+    void BlockBegin(int bufLen);
+    void BlockEnd(int bufLen);
+    void ChannelPitchUpdate(void);
+    void PitchInvalidate(void);
+    void LfoUpdate(int bufLen);
+    void ProcessVoice(struct synthVoice_s *voice, fm_sample_t *out, uint32_t pos, uint32_t len, float gain);
+    void ProcessVoiceList(struct fmVoiceList_s *list, fm_sample_t *out, uint32_t pos, uint32_t len, float gain);
+    void ProcessVoicePart(uint32_t part, uint32_t partCnt, fm_sample_t *out, uint32_t pos, uint32_t len);
+    void VoiceListCollect(struct fmVoiceList_s *list);
+    struct synthVoice_s *AllocVoice(void);
+
+    /* used for every block */
+    struct synthVoice_s *fmVoice;
+    uint32_t fmVoiceCnt;
+
+    struct fmVoiceList_s fmVoiceFree; /* not sounding */
+    struct fmVoiceList_s fmVoiceHeld; /* sounding, key is pressed */
+    struct fmVoiceList_s fmVoiceReleased; /* sounding, key has been released */
+
+    float multiplierPitchToAddValue; /* (1 << 32) / sample_rate */
+#ifdef FM_FIXED_POINT_ENABLED
+    uint32_t phaseModQ15; /* phase shift per Q15 input, same scaling as the float version */
+#endif
+    float processGain;
+    uint32_t blockLen; /* length of the current block, the lfo is interpolated over it */
+
+    /* pitch multiplier for each MIDI channel (pitchbend * lfo) at the start and the end of the block */
+    float chPitchMultiplierStart[FM_MIDI_CH_CNT];
+    float chPitchMultiplierEnd[FM_MIDI_CH_CNT];
+    /* amplitude reduction by the lfo at the start and the end of the block */
+    float chLfoAmStart[FM_MIDI_CH_CNT];
+    float chLfoAmEnd[FM_MIDI_CH_CNT];
+
+    /* lfo for each MIDI channel, evaluated once per block */
+    uint32_t chLfoPhase[FM_MIDI_CH_CNT];
+    float chLfoPitch[FM_MIDI_CH_CNT]; /* in semitones */
+
+    /* pow is only called when the pitchbend has been changed */
+    float chBendVar[FM_MIDI_CH_CNT];
+    float chBendMultiplier[FM_MIDI_CH_CNT];
+
+    float modulationDepth;
+    float pitchBendValue[FM_MIDI_CH_CNT];
+#ifdef PRESSURE_SENSOR_ENABLED
+    float pressureValue;
+    float pressureValueFilt;
+#endif
+
+    float sample_rate;
+
+    /* settings */
+    struct channelSettingParam_s channelSettings[FM_MIDI_CH_CNT];
+    struct channelSettingParam_s *currentChSetting;
+    uint8_t selectedOp;
+
+    bool initChannelSetting;
+    uint32_t initChannelSettingCnt;
+
+    struct op_properties_s op_props_silent;
+
+    const struct fm_patch_s *fmBank;
+    uint32_t fmBankCnt;
+#ifdef FM_BANK_FS_ENABLED
+    struct fm_patch_s fmBankRam[FM_BANK_PATCH_CNT];
+#endif
+};
+
+
+uint32_t FmSynth_VoiceMemSize(uint32_t voice_cnt);
 void FmSynth_Init(float sample_rate_in);
+void FmSynth_Init(float sample_rate_in, void *voice_mem, uint32_t voice_cnt);
 void FmSynth_Process(const float *in, float *out, int bufLen);
+void FmSynth_ProcessBegin(int bufLen);
+void FmSynth_ProcessPart(uint32_t part, uint32_t partCnt, float *partial, int bufLen);
+void FmSynth_ProcessEnd(float **partials, uint32_t partCnt, float *out, int bufLen);
 void FmSynth_NoteOn(uint8_t ch, uint8_t note, float vel);
 void FmSynth_NoteOff(uint8_t ch, uint8_t note);
 void FmSynth_PitchBend(uint8_t ch, float bend);
@@ -80,6 +388,11 @@ void FmSynth_MegaFM_CtrlChange(uint8_t ctrl, uint8_t value);
 
 void FmSynth_ChannelSettingDump(uint8_t ch __attribute__((unused)), float value);
 void FmSynth_ChannelSettingInit(uint8_t ch, float value);
+void FmSynth_ProgramChange(uint8_t ch, uint8_t program);
+#ifdef FM_BANK_FS_ENABLED
+bool FmSynth_BankLoad(fs_id_t id, const char *filename);
+bool FmSynth_BankSave(fs_id_t id, const char *filename);
+#endif
 void FmSynth_ToggleMono(uint8_t param __attribute__((unused)), float value);
 void FmSynth_ToggleLegato(uint8_t param __attribute__((unused)), float value);
 void FmSynth_SelectOp(uint8_t param, float value);
@@ -93,7 +406,13 @@ void FmSynth_Decay1(uint8_t unused __attribute__((unused)), float value);
 void FmSynth_DecayL(uint8_t unused __attribute__((unused)), float value);
 void FmSynth_Decay2(uint8_t unused __attribute__((unused)), float value);
 void FmSynth_Release(uint8_t unused __attribute__((unused)), float value);
+void FmSynth_KeyScale(uint8_t unused __attribute__((unused)), float value);
+void FmSynth_SsgEg(uint8_t unused __attribute__((unused)), float value);
 void FmSynth_Feedback(uint8_t unused __attribute__((unused)), float value);
+void FmSynth_ToggleLfo(uint8_t param __attribute__((unused)), float value);
+void FmSynth_LfoSpeed(uint8_t unused __attribute__((unused)), float value);
+void FmSynth_LfoFms(uint8_t unused __attribute__((unused)), float value);
+void FmSynth_LfoAms(uint8_t unused __attribute__((unused)), float value);
 
 
 #endif /* SRC_ML_FM_H_ */
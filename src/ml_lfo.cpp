@@ -49,68 +49,182 @@
 #include <string.h>
 
 
+#define LFO_FRAC_BIT    (32 - ML_LFO_TABLE_BIT)
+
+
+float ML_LFO::sineTable[ML_LFO_TABLE_SIZE + 1];
+bool ML_LFO::sineTableReady = false;
+
 ML_LFO::ML_LFO(float sample_rate, float *buffer, uint32_t sample_count)
 {
+    if (!sineTableReady)
+    {
+        for (uint32_t i = 0; i <= ML_LFO_TABLE_SIZE; i++)
+        {
+            sineTable[i] = sinf(2.0f * M_PI * ((float)i) / ((float)ML_LFO_TABLE_SIZE));
+        }
+        sineTableReady = true;
+    }
+
     this->sample_rate = sample_rate;
+    phaseScale = 4294967296.0f / sample_rate;
     frequency = 1.0f;
-    phase = 0.0f;
+    addVal = Increment(frequency);
+    phase = 0;
+    shape = lfo_sine;
+    random = 0x12345678;
+    holdValue = 0.0f;
+    decimation = 1;
+    decCnt = 0;
+    decValue = 0.0f;
+    decTarget = 0.0f;
+    decStep = 0.0f;
     this->buffer = buffer;
     bufferSize = sample_count;
     memset(buffer, 0, sizeof(float) * sample_count);
 }
 
-void ML_LFO::Process(const float *frequency_in, float *buffer, uint32_t len)
+inline uint32_t ML_LFO::Increment(float frequency)
+{
+    /* via int64_t to allow negative frequencies */
+    return (uint32_t)(int64_t)(frequency * phaseScale);
+}
+
+inline void ML_LFO::Advance(uint32_t inc)
 {
-    for (uint32_t n = 0; n < len; n++)
+    uint32_t lastPhase = phase;
+    phase += inc;
+    if (shape == lfo_sample_hold)
     {
-        const float omega = frequency_in[n] * 2.0f * M_PI / (sample_rate);
+        /* new value with each cycle */
+        if ((int32_t)inc >= 0 ? (phase < lastPhase) : (phase > lastPhase))
+        {
+            random = random * 1664525UL + 1013904223UL;
+            holdValue = ((float)(int32_t)random) * (1.0f / 2147483648.0f);
+        }
+    }
+}
 
-        phase += omega;
-        if (phase >= 2.0f * M_PI)
+inline float ML_LFO::Value(void)
+{
+    switch (shape)
+    {
+    case lfo_triangle:
+        {
+            /* 0 at phase 0 like the sine */
+            int32_t q = (int32_t)(phase + 0x40000000UL);
+            uint32_t a = (q < 0) ? (0UL - (uint32_t)q) : (uint32_t)q;
+            return ((float)a) * (1.0f / 1073741824.0f) - 1.0f;
+        }
+    case lfo_saw:
+        return ((float)(int32_t)phase) * (1.0f / 2147483648.0f);
+    case lfo_square:
+        return (phase < 0x80000000UL) ? 1.0f : -1.0f;
+    case lfo_sample_hold:
+        return holdValue;
+    case lfo_sine:
+    default:
         {
-            phase -= 2.0f * M_PI;
+            uint32_t idx = phase >> LFO_FRAC_BIT;
+            float frac = ((float)(phase & ((1UL << LFO_FRAC_BIT) - 1))) * (1.0f / (float)(1UL << LFO_FRAC_BIT));
+            return sineTable[idx] + (sineTable[idx + 1] - sineTable[idx]) * frac;
         }
-        buffer[n] = sinf(phase);
     }
 }
 
-void ML_LFO::Process(const float *frequency_in, uint32_t len)
+void ML_LFO::Render(const float *frequency_in, float *buffer, uint32_t len)
 {
-    for (uint32_t n = 0; n < len; n++)
+    if (decimation > 1)
     {
-        const float omega = frequency_in[n] * 2.0f * M_PI / (sample_rate);
+        RenderDecimated(frequency_in, buffer, len);
+        return;
+    }
 
-        phase += omega;
-        if (phase >= 2.0f * M_PI)
+    if (frequency_in != NULL)
+    {
+        for (uint32_t n = 0; n < len; n++)
+        {
+            Advance(Increment(frequency_in[n]));
+            buffer[n] = Value();
+        }
+    }
+    else
+    {
+        for (uint32_t n = 0; n < len; n++)
         {
-            phase -= 2.0f * M_PI;
+            Advance(addVal);
+            buffer[n] = Value();
         }
-        buffer[n] = sinf(phase);
     }
 }
 
-void ML_LFO::Process(uint32_t len)
+/*
+ * control rate, the frequency input is only read at the start of each segment
+ */
+void ML_LFO::RenderDecimated(const float *frequency_in, float *buffer, uint32_t len)
 {
-    const float omega = frequency * 2.0f * M_PI / (sample_rate);
+    uint32_t n = 0;
 
-    for (uint32_t n = 0; n < len; n++)
+    while (n < len)
     {
-        phase += omega;
-        if (phase >= 2.0f * M_PI)
+        if (decCnt == 0)
+        {
+            uint32_t inc = (frequency_in != NULL) ? Increment(frequency_in[n]) : addVal;
+            Advance(inc * decimation);
+            decValue = decTarget;
+            decTarget = Value();
+            decStep = (decTarget - decValue) * (1.0f / (float)decimation);
+            decCnt = decimation;
+        }
+
+        uint32_t cnt = (decCnt < len - n) ? decCnt : (len - n);
+        for (uint32_t i = 1; i <= cnt; i++)
         {
-            phase -= 2.0f * M_PI;
+            buffer[n++] = decValue + decStep * (float)i;
         }
-        buffer[n] = sinf(phase);
+        decValue += decStep * (float)cnt;
+        decCnt -= cnt;
     }
 }
 
+void ML_LFO::Process(const float *frequency_in, float *buffer, uint32_t len)
+{
+    Render(frequency_in, buffer, len);
+}
+
+void ML_LFO::Process(const float *frequency_in, uint32_t len)
+{
+    Render(frequency_in, buffer, len);
+}
+
+void ML_LFO::Process(uint32_t len)
+{
+    Render(NULL, buffer, len);
+}
+
 void ML_LFO::setFrequency(float frequency)
 {
     this->frequency = frequency;
+    addVal = Increment(frequency);
 }
 
+/*
+ * phase in radians like before
+ */
 void ML_LFO::setPhase(float phase)
 {
-    this->phase = phase;
+    float cycles = phase * (float)(1.0 / (2.0 * M_PI));
+    cycles -= floorf(cycles);
+    this->phase = (uint32_t)(int64_t)(cycles * 4294967296.0f);
+}
+
+void ML_LFO::setShape(enum ml_lfo_shape_e shape)
+{
+    this->shape = shape;
 }
 
+void ML_LFO::setDecimation(uint32_t decimation)
+{
+    this->decimation = (decimation > 0) ? decimation : 1;
+    decCnt = 0;
+}
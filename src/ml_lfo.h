@@ -46,6 +46,25 @@
 #include <inttypes.h>
 
 
+#ifndef ML_LFO_TABLE_BIT
+#define ML_LFO_TABLE_BIT    8
+#endif
+#define ML_LFO_TABLE_SIZE   (1UL << ML_LFO_TABLE_BIT)
+
+enum ml_lfo_shape_e
+{
+    lfo_sine,
+    lfo_triangle,
+    lfo_saw,
+    lfo_square,
+    lfo_sample_hold,
+};
+
+/*
+ * 32 bit phase accumulator, the sine is taken from a shared table with linear interpolation
+ * - setDecimation(n) evaluates the shape once every n samples and interpolates linearly in between
+ *   (the output follows n samples later, steps of square and sample & hold become ramps)
+ */
 class ML_LFO
 {
 public:
@@ -56,13 +75,34 @@ public:
     void Process(uint32_t len);
     void setFrequency(float speed);
     void setPhase(float phase);
+    void setShape(enum ml_lfo_shape_e shape);
+    void setDecimation(uint32_t decimation);
 
 private:
+    void Render(const float *frequency_in, float *buffer, uint32_t len);
+    void RenderDecimated(const float *frequency_in, float *buffer, uint32_t len);
+    inline uint32_t Increment(float frequency);
+    inline void Advance(uint32_t inc);
+    inline float Value(void);
+
     float sample_rate;
     float frequency;
-    float phase;
+    float phaseScale; /* 2^32 / sample_rate */
+    uint32_t phase;
+    uint32_t addVal;
+    enum ml_lfo_shape_e shape;
+    uint32_t random;
+    float holdValue;
+    uint32_t decimation;
+    uint32_t decCnt;
+    float decValue;
+    float decTarget;
+    float decStep;
     float *buffer;
     float bufferSize;
+
+    static float sineTable[ML_LFO_TABLE_SIZE + 1];
+    static bool sineTableReady;
 };
 
 
@@ -42,27 +42,153 @@
 
 #include "ml_osc.h"
 #include "ml_waveform.h"
+#include "ml_status.h"
 
 
-static void OscProcessSingle(oscillatorT *osc, uint32_t len);
+#include <math.h>
+#include <stdlib.h>
+
+
+static void OscProcessSingle(oscillatorT *osc, uint32_t len, const float *waveForm);
 
 
 /* will be removed in future */
 extern float sine[WAVEFORM_CNT];
 extern float saw[WAVEFORM_CNT];
 
-static void OscProcessSingle(oscillatorT *osc, uint32_t len)
+/*
+ * creates the band-limited levels of waveForm
+ * the harmonics are taken from a DFT of the source and summed up again for each level
+ * this is only done once during the initialization (heap: (OSC_MIP_LEVELS - 1) tables)
+ */
+bool OscMipMap_Init(struct osc_mipmap_s *mipMap, const float *waveForm)
 {
+    const uint32_t harmonicCnt = WAVEFORM_CNT / 2;
+
+    mipMap->level[0] = waveForm;
+    for (uint32_t l = 1; l < OSC_MIP_LEVELS; l++)
+    {
+        mipMap->level[l] = waveForm;
+    }
+
+    float *cosTable = (float *)malloc(sizeof(float) * WAVEFORM_CNT);
+    float *re = (float *)malloc(sizeof(float) * harmonicCnt);
+    float *im = (float *)malloc(sizeof(float) * harmonicCnt);
+
+    if ((cosTable == NULL) || (re == NULL) || (im == NULL))
+    {
+        Status_LogMessage("not enough heap memory for mip map!\n");
+        free(cosTable);
+        free(re);
+        free(im);
+        return false;
+    }
+
+    for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+    {
+        cosTable[n] = (float)cos(n * 2.0 * M_PI / WAVEFORM_CNT);
+    }
+
+    /* sin(x) is cos(x - pi/2) */
+    for (uint32_t k = 0; k < harmonicCnt; k++)
+    {
+        float sumRe = 0.0f;
+        float sumIm = 0.0f;
+        for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+        {
+            const uint32_t i = (k * n) & WAVEFORM_MSK;
+            sumRe += waveForm[n] * cosTable[i];
+            sumIm += waveForm[n] * cosTable[(i - WAVEFORM_Q4) & WAVEFORM_MSK];
+        }
+        re[k] = sumRe * ((k == 0) ? 1.0f : 2.0f) / WAVEFORM_CNT;
+        im[k] = sumIm * 2.0f / WAVEFORM_CNT;
+    }
+
+    bool ok = true;
+
+    for (uint32_t l = 1; l < OSC_MIP_LEVELS; l++)
+    {
+        float *table = (float *)malloc(sizeof(float) * WAVEFORM_CNT);
+        if (table == NULL)
+        {
+            Status_LogMessage("not enough heap memory for mip map!\n");
+            ok = false;
+            break;
+        }
+
+        const uint32_t maxHarmonic = harmonicCnt >> l;
+
+        for (uint32_t n = 0; n < WAVEFORM_CNT; n++)
+        {
+            float sig = re[0];
+            for (uint32_t k = 1; k <= maxHarmonic; k++)
+            {
+                const uint32_t i = (k * n) & WAVEFORM_MSK;
+                sig += re[k] * cosTable[i] + im[k] * cosTable[(i - WAVEFORM_Q4) & WAVEFORM_MSK];
+            }
+            table[n] = sig;
+        }
+
+        mipMap->level[l] = table;
+    }
+
+    /* levels which could not be allocated are using the narrowest available one */
+    for (uint32_t l = 1; l < OSC_MIP_LEVELS; l++)
+    {
+        if (mipMap->level[l] == waveForm)
+        {
+            mipMap->level[l] = mipMap->level[l - 1];
+        }
+    }
+
+    free(cosTable);
+    free(re);
+    free(im);
+
+    return ok;
+}
+
+/*
+ * returns the level where all harmonics are below the nyquist frequency
+ * level 0 is used up to an increment of 1 << (32 - WAVEFORM_BIT)
+ */
+const float *OscMipMap_Select(const struct osc_mipmap_s *mipMap, uint32_t addVal)
+{
+    uint32_t octave = addVal >> (32 - WAVEFORM_BIT);
+    uint32_t l = 0;
+
+    while ((octave > 0) && (l < OSC_MIP_LEVELS - 1))
+    {
+        octave >>= 1;
+        l++;
+    }
+
+    return mipMap->level[l];
+}
+
+/*
+ * the modulation sources are only changed between the blocks
+ * reading them once per block avoids reloading them after every write to dest
+ */
+static inline uint32_t OscAddVal(const oscillatorT *osc)
+{
+    return (uint32_t)((*osc->cfg->pitchMultiplier) * ((float)osc->addVal) * osc->cfg->pitchOctave * osc->cfg->pitch * *osc->pitchMod);
+}
+
+static void OscProcessSingle(oscillatorT *osc, uint32_t len, const float *waveForm)
+{
+    const uint32_t addVal = OscAddVal(osc);
+    const float morphScale = ((float)89478480) * (*osc->cfg->morph) * 64;
+
     for (uint32_t n = 0U; n < len; n++)
     {
-        osc->samplePos += (uint32_t)((*osc->cfg->pitchMultiplier) * ((float)osc->addVal) * osc->cfg->pitchOctave * osc->cfg->pitch * *osc->pitchMod);
+        osc->samplePos += addVal;
         uint32_t samplePos = osc->samplePos;
         float morphMod = /*(*osc->cfg->morph) * */ osc->cfg->morphWaveForm[WAVEFORM_I(osc->samplePos)];
-        morphMod *= ((float)89478480);
-        morphMod *= (*osc->cfg->morph) * 64;
+        morphMod *= morphScale;
         samplePos += morphMod;
 
-        float sig = osc->cfg->selectedWaveForm[WAVEFORM_I(samplePos)];
+        float sig = waveForm[WAVEFORM_I(samplePos)];
 #ifdef NOT_USED
         float sig = 0;
         if (saw == NULL)
@@ -91,6 +217,245 @@ void OscProcess(oscillatorT *osc, int cnt, uint32_t len)
 {
     for (int i = 0; i < cnt; i++)
     {
-        OscProcessSingle(&osc[i], len);
+        OscProcessSingle(&osc[i], len, osc[i].cfg->selectedWaveForm);
+    }
+}
+
+/*
+ * like OscProcess, the table of the mip map is selected per oscillator from its phase increment
+ */
+void OscProcessMipMap(oscillatorT *osc, int cnt, uint32_t len, const struct osc_mipmap_s *mipMap)
+{
+    for (int i = 0; i < cnt; i++)
+    {
+        OscProcessSingle(&osc[i], len, OscMipMap_Select(mipMap, OscAddVal(&osc[i])));
+    }
+}
+
+void OscBank_Init(struct osc_bank_s *bank, struct synth_osc_cfg_s *cfg, float *pitchMod, float *dest_l, float *dest_r)
+{
+    bank->cnt = 0;
+    bank->cfg = cfg;
+    bank->pitchMod = pitchMod;
+    bank->mipMap = NULL;
+    bank->dest[0] = dest_l;
+    bank->dest[1] = dest_r;
+}
+
+/*
+ * NULL uses selectedWaveForm of the configuration
+ */
+void OscBank_SetMipMap(struct osc_bank_s *bank, const struct osc_mipmap_s *mipMap)
+{
+    bank->mipMap = mipMap;
+}
+
+/*
+ * returns false when the bank is already full
+ */
+bool OscBank_Add(struct osc_bank_s *bank, uint32_t addVal, float pan_l, float pan_r)
+{
+    if (bank->cnt >= OSC_BANK_MAX)
+    {
+        return false;
     }
+
+    bank->samplePos[bank->cnt] = 0;
+    bank->addVal[bank->cnt] = addVal;
+    bank->pan_l[bank->cnt] = pan_l;
+    bank->pan_r[bank->cnt] = pan_r;
+    bank->cnt++;
+
+    return true;
+}
+
+/*
+ * renders the oscillators like OscProcess with one oscillatorT per bank entry
+ * - each oscillator is rendered into a local sum buffer, the destination is written once per sample
+ * - the morph offset is added to the table index which avoids the float conversion of the phase
+ */
+#define OSC_BANK_BLOCK  32
+
+void OscBank_Process(struct osc_bank_s *bank, uint32_t len)
+{
+    const struct synth_osc_cfg_s *cfg = bank->cfg;
+    const uint32_t cnt = bank->cnt;
+
+    /* block constant modulation */
+    const float pitch = (*cfg->pitchMultiplier) * cfg->pitchOctave * cfg->pitch * (*bank->pitchMod);
+    const float morphScale = ((float)89478480) * (*cfg->morph) * 64 * (1.0f / (float)(1UL << (32 - WAVEFORM_BIT)));
+    const float volume = cfg->volume;
+    const float *morphWaveForm = cfg->morphWaveForm;
+    const struct osc_mipmap_s *mipMap = bank->mipMap;
+
+    uint32_t add[OSC_BANK_MAX];
+
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        add[i] = (uint32_t)(pitch * (float)bank->addVal[i]);
+    }
+
+    float *dest_l = bank->dest[0];
+    float *dest_r = bank->dest[1];
+
+    for (uint32_t n0 = 0U; n0 < len; n0 += OSC_BANK_BLOCK)
+    {
+        const uint32_t blockLen = ((len - n0) < OSC_BANK_BLOCK) ? (len - n0) : OSC_BANK_BLOCK;
+        float sig_l[OSC_BANK_BLOCK] = {0};
+#ifdef SAW_PAN_ENABLED
+        float sig_r[OSC_BANK_BLOCK] = {0};
+#endif
+
+        for (uint32_t i = 0; i < cnt; i++)
+        {
+            uint32_t samplePos = bank->samplePos[i];
+            const uint32_t addVal = add[i];
+            const float *waveForm = (mipMap != NULL) ? OscMipMap_Select(mipMap, addVal) : cfg->selectedWaveForm;
+#ifdef SAW_PAN_ENABLED
+            const float pan_l = bank->pan_l[i];
+            const float pan_r = bank->pan_r[i];
+#endif
+
+            for (uint32_t n = 0; n < blockLen; n++)
+            {
+                samplePos += addVal;
+
+                int32_t idx = WAVEFORM_I(samplePos);
+                idx += (int32_t)(morphWaveForm[idx] * morphScale);
+
+                float sig = waveForm[idx & WAVEFORM_MSK];
+#ifdef SAW_PAN_ENABLED
+                sig_l[n] += pan_l * sig;
+                sig_r[n] += pan_r * sig;
+#else
+                sig_l[n] += sig;
+#endif
+            }
+
+            bank->samplePos[i] = samplePos;
+        }
+
+        for (uint32_t n = 0; n < blockLen; n++)
+        {
+            dest_l[n0 + n] += sig_l[n] * volume;
+#ifdef SAW_PAN_ENABLED
+            dest_r[n0 + n] += sig_r[n] * volume;
+#else
+            dest_r[n0 + n] += sig_l[n] * volume;
+#endif
+        }
+    }
+}
+
+void OscBlep_Init(struct osc_blep_s *osc, uint8_t waveform, float *dest_l, float *dest_r)
+{
+    osc->samplePos = 0;
+    osc->addVal = 0;
+    osc->pulseWidth = 0.5f;
+    osc->pwMod = NULL;
+    osc->syncIn = NULL;
+    osc->syncOut = NULL;
+    osc->volume = 1.0f;
+    osc->dest[0] = dest_l;
+    osc->dest[1] = dest_r;
+    osc->waveform = waveform;
+    osc->delayed = 0.0f;
+}
+
+static inline float OscBlep_Naive(bool pulse, uint32_t pos, uint32_t pwPos)
+{
+    if (pulse)
+    {
+        return (pos < pwPos) ? 1.0f : -1.0f;
+    }
+    return (float)pos * (1.0f / 2147483648.0f) - 1.0f;
+}
+
+/*
+ * step of height h, d samples before the current sample (0..1)
+ */
+static inline void OscBlep_Step(float h, float d, float *corrPrev, float *corrCur)
+{
+    const float e = 1.0f - d;
+    *corrPrev += 0.5f * h * d * d;
+    *corrCur -= 0.5f * h * e * e;
+}
+
+static inline uint32_t OscBlep_PulseWidth(float pw)
+{
+    pw = (pw < 0.01f) ? 0.01f : ((pw > 0.99f) ? 0.99f : pw);
+    return (uint32_t)(pw * 4294967296.0f);
+}
+
+void OscBlep_Process(struct osc_blep_s *osc, uint32_t len)
+{
+    const uint32_t add = osc->addVal;
+    const float invAdd = (add > 0) ? (1.0f / (float)add) : 0.0f;
+    const bool pulse = osc->waveform == osc_blep_pulse;
+    const float volume = osc->volume;
+    const float *pwMod = osc->pwMod;
+    const float *syncIn = osc->syncIn;
+    float *syncOut = osc->syncOut;
+    float *dest_l = osc->dest[0];
+    float *dest_r = osc->dest[1];
+
+    uint32_t pos = osc->samplePos;
+    uint32_t pwPos = OscBlep_PulseWidth(osc->pulseWidth);
+    float delayed = osc->delayed;
+
+    for (uint32_t n = 0U; n < len; n++)
+    {
+        float corrPrev = 0.0f;
+        float corrCur = 0.0f;
+
+        if (pwMod != NULL)
+        {
+            pwPos = OscBlep_PulseWidth(pwMod[n]);
+        }
+
+        const float syncD = (syncIn != NULL) ? syncIn[n] : -1.0f;
+        const bool sync = syncD >= 0.0f;
+        const float ofs = sync ? syncD : 0.0f; /* time from the end of the phase movement to the sample */
+
+        /* phase at the end of the sample or at the moment of the sync */
+        const uint32_t start = pos;
+        const uint32_t end = sync ? (start + (uint32_t)((1.0f - syncD) * (float)add)) : (start + add);
+        const bool wrapped = end < start;
+
+        if (wrapped)
+        {
+            const float d = (float)end * invAdd + ofs;
+            OscBlep_Step(pulse ? 2.0f : -2.0f, d, &corrPrev, &corrCur);
+        }
+        if (syncOut != NULL)
+        {
+            syncOut[n] = wrapped ? ((float)end * invAdd + ofs) : -1.0f;
+        }
+
+        if (pulse && (wrapped ? ((start < pwPos) || (end >= pwPos)) : ((start < pwPos) && (end >= pwPos))))
+        {
+            const float d = (float)(end - pwPos) * invAdd + ofs;
+            OscBlep_Step(-2.0f, d, &corrPrev, &corrCur);
+        }
+
+        if (sync)
+        {
+            const float h = OscBlep_Naive(pulse, 0, pwPos) - OscBlep_Naive(pulse, end, pwPos);
+            OscBlep_Step(h, syncD, &corrPrev, &corrCur);
+            pos = (uint32_t)(syncD * (float)add);
+        }
+        else
+        {
+            pos = end;
+        }
+
+        const float sig = delayed + corrPrev;
+        delayed = OscBlep_Naive(pulse, pos, pwPos) + corrCur;
+
+        dest_l[n] += sig * volume;
+        dest_r[n] += sig * volume;
+    }
+
+    osc->samplePos = pos;
+    osc->delayed = delayed;
 }
@@ -49,8 +49,26 @@
 
 
 #include <stdint.h>
+#include "ml_waveform.h"
 
 
+/*
+ * band-limited copies of a waveform, one per octave
+ * - level n contains the harmonics up to WAVEFORM_CNT / 2 >> n
+ * - level 0 is the source waveform itself
+ * - the level is selected once per block from the phase increment
+ * - used by OscProcessMipMap and by an oscillator bank with OscBank_SetMipMap
+ *   (synth_osc_cfg_s is not extended, it is also used by the precompiled library)
+ */
+#ifndef OSC_MIP_LEVELS
+#define OSC_MIP_LEVELS  WAVEFORM_BIT
+#endif
+
+struct osc_mipmap_s
+{
+    const float *level[OSC_MIP_LEVELS];
+};
+
 struct synth_osc_cfg_s
 {
     uint8_t pitchOctave; /* multiplier to go to higher octaves */
@@ -78,7 +96,71 @@ struct oscillatorT
 };
 
 
+/*
+ * oscillator bank, a group of oscillators sharing one configuration (e.g. the saws of a supersaw voice)
+ * - phases and increments are kept as arrays which allows the compiler to vectorize the phase update
+ * - pitch, morph and volume are read once per block
+ * - the oscillators are summed before they are added to the destination buffers
+ */
+#ifndef OSC_BANK_MAX
+#define OSC_BANK_MAX    16
+#endif
+
+struct osc_bank_s
+{
+    uint32_t samplePos[OSC_BANK_MAX];
+    uint32_t addVal[OSC_BANK_MAX]; /* phase increment without pitch modulation */
+    float pan_l[OSC_BANK_MAX];
+    float pan_r[OSC_BANK_MAX];
+    uint32_t cnt;
+
+    float *dest[2];
+    float *pitchMod;
+    struct synth_osc_cfg_s *cfg;
+    const struct osc_mipmap_s *mipMap; /* optional band-limited version of selectedWaveForm, NULL when not used */
+};
+
+/*
+ * PolyBLEP oscillator, no tables required
+ * - the steps of the waveform (wrap, pulse edge, sync) are smoothed by a polynomial over two samples
+ * - the output is delayed by one sample which allows to correct the sample before a step
+ * - hard sync: the master writes the wrap positions to syncOut, the slave reads them from syncIn
+ *   (fraction of the sample passed since the wrap, negative when there was none)
+ */
+enum osc_blep_wave_e
+{
+    osc_blep_saw,
+    osc_blep_pulse,
+};
+
+struct osc_blep_s
+{
+    uint32_t samplePos;
+    uint32_t addVal;
+    float pulseWidth; /* 0..1, used when pwMod is NULL */
+    float *pwMod; /* optional, pulse width for every sample */
+    float *syncIn; /* optional, sync positions from the master */
+    float *syncOut; /* optional, wrap positions for the slaves */
+    float volume;
+    float *dest[2];
+    uint8_t waveform;
+    float delayed; /* output sample which is not yet written */
+};
+
+
 void OscProcess(oscillatorT *osc, int cnt, uint32_t len);
+void OscProcessMipMap(oscillatorT *osc, int cnt, uint32_t len, const struct osc_mipmap_s *mipMap);
+
+bool OscMipMap_Init(struct osc_mipmap_s *mipMap, const float *waveForm);
+const float *OscMipMap_Select(const struct osc_mipmap_s *mipMap, uint32_t addVal);
+
+void OscBank_Init(struct osc_bank_s *bank, struct synth_osc_cfg_s *cfg, float *pitchMod, float *dest_l, float *dest_r);
+bool OscBank_Add(struct osc_bank_s *bank, uint32_t addVal, float pan_l, float pan_r);
+void OscBank_SetMipMap(struct osc_bank_s *bank, const struct osc_mipmap_s *mipMap);
+void OscBank_Process(struct osc_bank_s *bank, uint32_t len);
+
+void OscBlep_Init(struct osc_blep_s *osc, uint8_t waveform, float *dest_l, float *dest_r);
+void OscBlep_Process(struct osc_blep_s *osc, uint32_t len);
 
 
 #endif /* ML_OSC_H_ */
@@ -186,35 +186,46 @@ void Reverb_Process(float *signal_l, int buffLen)
     Reverb_Process(signal_l, signal_l, buffLen);
 }
 
+/*
+ * longer blocks are processed in chunks of REVERB_CHUNK samples
+ */
 void Reverb_Process(const float *signal_l, float *out, int buffLen)
 {
-    static float inSample[96];
-    for (int n = 0; n < buffLen; n++)
-    {
-        /* create mono sample */
-        inSample[n] = signal_l[n]; /* it may cause unwanted audible effects */
-    }
-    float newsample[buffLen];
-    memset(newsample, 0, sizeof(newsample));
-    Do_Comb(&cf0, inSample, newsample, buffLen);
-    Do_Comb(&cf1, inSample, newsample, buffLen);
-    Do_Comb(&cf2, inSample, newsample, buffLen);
-    Do_Comb(&cf3, inSample, newsample, buffLen);
-    for (int n = 0; n < buffLen; n++)
+    float inSample[REVERB_CHUNK];
+    float newsample[REVERB_CHUNK];
+
+    for (int pos = 0; pos < buffLen; pos += REVERB_CHUNK)
     {
-        newsample[n] *= 0.25f;
-    }
+        const int len = (buffLen - pos < REVERB_CHUNK) ? (buffLen - pos) : REVERB_CHUNK;
+        const float *sig = &signal_l[pos];
+        float *dst = &out[pos];
 
-    Do_Allpass(&ap0, newsample, newsample, buffLen);
-    Do_Allpass(&ap1, newsample, newsample, buffLen);
-    Do_Allpass(&ap2, newsample, newsample, buffLen);
+        for (int n = 0; n < len; n++)
+        {
+            /* create mono sample */
+            inSample[n] = sig[n]; /* it may cause unwanted audible effects */
+        }
+        memset(newsample, 0, sizeof(float) * len);
+        Do_Comb(&cf0, inSample, newsample, len);
+        Do_Comb(&cf1, inSample, newsample, len);
+        Do_Comb(&cf2, inSample, newsample, len);
+        Do_Comb(&cf3, inSample, newsample, len);
+        for (int n = 0; n < len; n++)
+        {
+            newsample[n] *= 0.25f;
+        }
 
-    /* apply reverb level */
-    const float level = rev_level;
-    for (int n = 0; n < buffLen; n++)
-    {
-        newsample[n] *= level;
-        out[n] = signal_l[n] + newsample[n];
+        Do_Allpass(&ap0, newsample, newsample, len);
+        Do_Allpass(&ap1, newsample, newsample, len);
+        Do_Allpass(&ap2, newsample, newsample, len);
+
+        /* apply reverb level */
+        const float level = rev_level;
+        for (int n = 0; n < len; n++)
+        {
+            newsample[n] *= level;
+            dst[n] = sig[n] + newsample[n];
+        }
     }
 }
 
@@ -278,3 +289,173 @@ void Reverb_SetLevelInt(uint8_t not_used, uint8_t value)
     Reverb_SetLevel(not_used, val_f);
 }
 
+/*
+ * ML_Reverb
+ */
+static const uint32_t revCombLen[4] = {l_CB0, l_CB1, l_CB2, l_CB3};
+static const float revCombG[4] = {0.805f, 0.827f, 0.783f, 0.764f};
+static const uint32_t revAllpassLen[3] = {l_AP0, l_AP1, l_AP2};
+
+/*
+ * the lines are processed in contiguous spans, the wrap is checked once per span
+ */
+static inline void Reverb_Comb(struct reverb_line_s *cf, const float *inSample, float *outSample, uint32_t len)
+{
+    float *buf = cf->buf;
+    const float g = cf->g;
+    uint32_t p = cf->p;
+
+    uint32_t n = 0;
+    while (n < len)
+    {
+        uint32_t span = cf->lim - p;
+        span = (span < len - n) ? span : (len - n);
+
+        float *line = &buf[p];
+        const float *in = &inSample[n];
+        float *out = &outSample[n];
+        for (uint32_t i = 0; i < span; i++)
+        {
+            const float readback = line[i];
+            line[i] = readback * g + in[i];
+            out[i] += readback;
+        }
+
+        n += span;
+        p += span;
+        if (p >= cf->lim)
+        {
+            p = 0;
+        }
+    }
+
+    cf->p = p;
+}
+
+static inline void Reverb_Allpass(struct reverb_line_s *ap, float *sample, uint32_t len)
+{
+    float *buf = ap->buf;
+    const float g = ap->g;
+    uint32_t p = ap->p;
+
+    uint32_t n = 0;
+    while (n < len)
+    {
+        uint32_t span = ap->lim - p;
+        span = (span < len - n) ? span : (len - n);
+
+        float *line = &buf[p];
+        float *sig = &sample[n];
+        for (uint32_t i = 0; i < span; i++)
+        {
+            const float readback = line[i] - g * sig[i];
+            line[i] = readback * g + sig[i];
+            sig[i] = readback;
+        }
+
+        n += span;
+        p += span;
+        if (p >= ap->lim)
+        {
+            p = 0;
+        }
+    }
+
+    ap->p = p;
+}
+
+ML_Reverb::ML_Reverb(float *buffer)
+{
+    this->buffer = buffer;
+    level = 0.0f;
+
+    if (buffer == NULL)
+    {
+        Status_LogMessage("No memory to initialize Reverb!\n");
+    }
+
+    uint32_t i = 0;
+    for (uint32_t ch = 0; ch < 2; ch++)
+    {
+        for (uint32_t k = 0; k < 4; k++)
+        {
+            struct reverb_line_s *cf = &state.comb[ch][k];
+            cf->buf = (buffer != NULL) ? &buffer[i] : NULL;
+            cf->p = 0;
+            cf->lim = revCombLen[k] + ((ch == 1) ? REV_STEREO_SPREAD : 0);
+            cf->g = revCombG[k];
+            i += cf->lim;
+        }
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            struct reverb_line_s *ap = &state.allpass[ch][k];
+            ap->buf = (buffer != NULL) ? &buffer[i] : NULL;
+            ap->p = 0;
+            ap->lim = revAllpassLen[k];
+            ap->g = 0.7f;
+            i += ap->lim;
+        }
+    }
+
+    Reset();
+}
+
+void ML_Reverb::Reset(void)
+{
+    if (buffer != NULL)
+    {
+        memset(buffer, 0, sizeof(float) * ML_REVERB_BUFF_SIZE);
+    }
+}
+
+void ML_Reverb::Process(const float *in_l, const float *in_r, float *out_l, float *out_r, uint32_t len)
+{
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    float inSample[REVERB_CHUNK];
+    float wet[2][REVERB_CHUNK];
+
+    for (uint32_t pos = 0; pos < len; pos += REVERB_CHUNK)
+    {
+        const uint32_t cnt = (len - pos < REVERB_CHUNK) ? (len - pos) : REVERB_CHUNK;
+
+        for (uint32_t n = 0; n < cnt; n++)
+        {
+            inSample[n] = 0.5f * (in_l[pos + n] + in_r[pos + n]);
+        }
+
+        for (uint32_t ch = 0; ch < 2; ch++)
+        {
+            float *w = wet[ch];
+
+            memset(w, 0, sizeof(float) * cnt);
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                Reverb_Comb(&state.comb[ch][k], inSample, w, cnt);
+            }
+            for (uint32_t n = 0; n < cnt; n++)
+            {
+                w[n] *= 0.25f;
+            }
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                Reverb_Allpass(&state.allpass[ch][k], w, cnt);
+            }
+        }
+
+        for (uint32_t n = 0; n < cnt; n++)
+        {
+            out_l[pos + n] = in_l[pos + n] + wet[0][n] * level;
+            out_r[pos + n] = in_r[pos + n] + wet[1][n] * level;
+        }
+    }
+}
+
+void ML_Reverb::setLevel(float value)
+{
+    level = value;
+    Status_ValueChangedFloat("Reverb", "Level", level);
+}
@@ -61,6 +61,13 @@
 
 #define REV_BUFF_SIZE   (l_CB0 + l_CB1 + l_CB2 + l_CB3 + l_AP0 + l_AP1 + l_AP2)
 
+/* longer combs of the right channel for decorrelation */
+#define REV_STEREO_SPREAD   REV_MUL(23)
+
+#define ML_REVERB_BUFF_SIZE (2 * REV_BUFF_SIZE + 4 * REV_STEREO_SPREAD)
+
+#define REVERB_CHUNK    96 /* samples processed at once, any block length is split into chunks */
+
 
 void Reverb_Process(float *signal_l, int buffLen);
 void Reverb_Process(const float *signal_l, float *out, int buffLen);
@@ -69,4 +76,40 @@ void Reverb_SetLevel(uint8_t not_used, float value);
 void Reverb_SetLevelInt(uint8_t not_used, uint8_t value);
 
 
+struct reverb_line_s
+{
+    float *buf;
+    uint32_t p;
+    uint32_t lim;
+    float g;
+};
+
+/*
+ * instance based stereo version of the reverb above
+ * - the buffer requires ML_REVERB_BUFF_SIZE floats
+ * - both inputs are mixed into two comb / allpass chains with different lengths
+ * - any block length can be processed, in place processing is allowed
+ */
+class ML_Reverb
+{
+public:
+    ML_Reverb(float *buffer);
+    ~ML_Reverb() {};
+    void Reset(void);
+    void Process(const float *in_l, const float *in_r, float *out_l, float *out_r, uint32_t len);
+    void setLevel(float value);
+
+private:
+    /* all lines of both channels in one block */
+    struct reverb_state_s
+    {
+        struct reverb_line_s comb[2][4];
+        struct reverb_line_s allpass[2][3];
+    } state;
+
+    float *buffer;
+    float level;
+};
+
+
 #endif /* SRC_ML_REVERB_H_ */